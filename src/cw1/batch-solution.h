@@ -0,0 +1,209 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <cw1/solution.h>
+#include <cw1/test.h>
+
+enum class BatchActionType {
+    None,
+    Move,
+    Attack
+};
+
+// One action per lane, lanes with BatchActionType::None skip the turn entirely
+template<std::size_t N>
+struct BatchActions {
+    std::array<BatchActionType, N> type;
+    std::array<int, N> x;
+    std::array<int, N> y;
+    std::array<int, N> target;
+
+    BatchActions() {
+        type.fill(BatchActionType::None);
+        x.fill(0);
+        y.fill(0);
+        target.fill(0);
+    }
+
+    void move(std::size_t lane, const Position& position) {
+        move(lane, position.x, position.y);
+    }
+
+    void move(std::size_t lane, int newX, int newY) {
+        type[lane] = BatchActionType::Move;
+        x[lane] = newX;
+        y[lane] = newY;
+    }
+
+    void attack(std::size_t lane, int newTarget) {
+        type[lane] = BatchActionType::Attack;
+        target[lane] = newTarget;
+    }
+};
+
+// Advances N independent rollouts over the same test in lockstep
+// Hero state is stored column-wise so per-monster data is read once per turn for the whole batch
+template<std::size_t N>
+struct BatchState {
+    Test test;
+
+    std::array<int, N> x;
+    std::array<int, N> y;
+
+    std::array<int, N> speed;
+    std::array<int, N> power;
+    std::array<int, N> range;
+
+    std::array<int, N> gold;
+    std::array<int, N> exp;
+    std::array<int, N> level;
+
+    std::array<long long, N> fatigue;
+
+    // Indexed by monster id
+    std::vector<std::array<long long, N>> monsterHp;
+
+    // Only monsters that can attack, so tests without attacks skip the fatigue pass altogether
+    std::vector<int> attackerIds;
+    std::vector<long long> attackerX;
+    std::vector<long long> attackerY;
+    std::vector<long long> attackerRangeSquared;
+    std::vector<long long> attackerAttack;
+
+    explicit BatchState(const Test& test)
+        : test(test) {
+        x.fill(test.startPosition.x);
+        y.fill(test.startPosition.y);
+
+        speed.fill(test.hero.baseSpeed);
+        power.fill(test.hero.basePower);
+        range.fill(test.hero.baseRange);
+
+        gold.fill(0);
+        exp.fill(0);
+        level.fill(0);
+
+        fatigue.fill(0);
+
+        monsterHp.resize(test.monsters.size());
+        for (const auto& monster : test.monsters) {
+            monsterHp[monster.id].fill(monster.hp);
+
+            if (monster.attack > 0) {
+                attackerIds.emplace_back(monster.id);
+                attackerX.emplace_back(monster.position.x);
+                attackerY.emplace_back(monster.position.y);
+                attackerRangeSquared.emplace_back(monster.range * monster.range);
+                attackerAttack.emplace_back(monster.attack);
+            }
+        }
+    }
+
+    Position position(std::size_t lane) const {
+        return {x[lane], y[lane]};
+    }
+
+    bool isAlive(std::size_t lane, int monsterId) const {
+        return monsterHp[monsterId][lane] > 0;
+    }
+
+    void apply(const BatchActions<N>& actions) {
+        for (std::size_t lane = 0; lane < N; ++lane) {
+            switch (actions.type[lane]) {
+                case BatchActionType::Move:
+                    x[lane] = actions.x[lane];
+                    y[lane] = actions.y[lane];
+                    break;
+                case BatchActionType::Attack:
+                    applyAttack(lane, actions.target[lane]);
+                    break;
+                case BatchActionType::None:
+                    break;
+            }
+        }
+
+        applyAttacks(actions);
+    }
+
+    // Extracts a single lane as a scalar state, the result matches an independent run of the scalar simulator
+    State toState(std::size_t lane) const {
+        State state(test);
+
+        state.position = position(lane);
+
+        state.speed = speed[lane];
+        state.power = power[lane];
+        state.range = range[lane];
+
+        state.gold = gold[lane];
+        state.exp = exp[lane];
+        state.level = level[lane];
+
+        state.fatigue = fatigue[lane];
+
+        for (auto& monster : state.test.monsters) {
+            monster.hp = monsterHp[monster.id][lane];
+        }
+
+        return state;
+    }
+
+private:
+    void applyAttack(std::size_t lane, int target) {
+        const auto& monster = test.monsters[target];
+        auto& hp = monsterHp[target][lane];
+
+        hp -= power[lane];
+        if (hp > 0) {
+            return;
+        }
+
+        gold[lane] += calculateGold(monster.gold, fatigue[lane]);
+        exp[lane] += monster.exp;
+
+        int oldLevel = level[lane];
+
+        while (true) {
+            int requiredExp = 1000 + (level[lane] + 1) * level[lane] * 50;
+            if (exp[lane] < requiredExp) {
+                break;
+            }
+
+            exp[lane] -= requiredExp;
+            ++level[lane];
+        }
+
+        if (level[lane] != oldLevel) {
+            speed[lane] = calculateStat(level[lane], test.hero.baseSpeed, test.hero.coeffSpeed);
+            power[lane] = calculateStat(level[lane], test.hero.basePower, test.hero.coeffPower);
+            range[lane] = calculateStat(level[lane], test.hero.baseRange, test.hero.coeffRange);
+        }
+    }
+
+    void applyAttacks(const BatchActions<N>& actions) {
+        std::array<long long, N> active;
+        for (std::size_t lane = 0; lane < N; ++lane) {
+            active[lane] = actions.type[lane] != BatchActionType::None;
+        }
+
+        for (std::size_t i = 0; i < attackerIds.size(); ++i) {
+            long long monsterX = attackerX[i];
+            long long monsterY = attackerY[i];
+            long long rangeSquared = attackerRangeSquared[i];
+            long long attack = attackerAttack[i];
+
+            const auto& hp = monsterHp[attackerIds[i]];
+
+            for (std::size_t lane = 0; lane < N; ++lane) {
+                long long dx = x[lane] - monsterX;
+                long long dy = y[lane] - monsterY;
+
+                bool hit = hp[lane] > 0 && dx * dx + dy * dy <= rangeSquared;
+                fatigue[lane] += hit ? attack * active[lane] : 0;
+            }
+        }
+    }
+};
@@ -2,6 +2,7 @@
 
 #include <cstdlib>
 #include <filesystem>
+#include <optional>
 #include <string>
 
 #include <spdlog/spdlog.h>
@@ -27,3 +28,13 @@ inline std::string getApiToken() {
 inline std::filesystem::path getDataDirectory() {
     return getPathFromEnv("DATA_DIRECTORY");
 }
+
+// When set, solvers run as workers that pull jobs from and push solutions to the coordinator at this url
+inline std::optional<std::string> getCoordinatorUrl() {
+    const char* value = std::getenv("COORDINATOR_URL");
+    if (value == nullptr || *value == '\0') {
+        return std::nullopt;
+    }
+
+    return value;
+}
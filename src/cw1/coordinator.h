@@ -0,0 +1,325 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <ankerl/unordered_dense.h>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <cw1/job.h>
+#include <cw1/program.h>
+#include <cw1/reference-solution.h>
+#include <cw1/solution-io.h>
+#include <cw1/test.h>
+
+// Hands out jobs to workers over HTTP and owns submission, so only one process talks to the scoreboard
+//
+// GET  /api/job?solver=<name>            next job for the solver with its lease and the test's incumbent score,
+//                                        503 with Retry-After while the solver's remaining jobs are all leased,
+//                                        204 when there are none left
+// POST /api/job/<id>/renew?lease=<token>  extends the lease, 409 when it has expired and the job was requeued
+// POST /api/job/<id>/finish?lease=<token> marks a job as done, the coordinator stops once every job is finished
+// POST /api/solution/<test>               validates a solution, submits it if it improves the incumbent, returns all
+//                                        incumbents
+// GET  /api/incumbents                    best known score per test
+//
+// Assigned jobs are leased and workers renew the lease while they solve, a job whose lease runs out is handed out
+// again so a worker that dies or loses its connection cannot keep the coordinator running forever. Every assignment
+// gets its own token, so a late finish from an expired lease cannot end the lease of the worker the job was
+// reassigned to.
+class Coordinator {
+    struct Lease {
+        Job job;
+        std::uint64_t token;
+        std::chrono::steady_clock::time_point expiresAt;
+    };
+
+    Program& program;
+    ankerl::unordered_dense::map<int, Test> tests;
+
+    httplib::Server server;
+
+    std::deque<Job> pendingJobs;
+    ankerl::unordered_dense::map<int, Lease> runningJobs;
+    int nextJobId = 1;
+    std::uint64_t nextLeaseToken = 1;
+    std::chrono::seconds leaseDuration;
+    std::mutex jobsMutex;
+
+    // Program::submit compares and then updates the best score, concurrent pushes for one test would race
+    std::mutex submitMutex;
+
+public:
+    Coordinator(Program& program, const std::vector<Test>& selectedTests, std::chrono::seconds leaseDuration)
+        : program(program),
+          leaseDuration(leaseDuration) {
+        for (const auto& test : selectedTests) {
+            tests.emplace(test.id, test);
+        }
+
+        server.Get(
+            "/api/job",
+            [&](const httplib::Request& req, httplib::Response& res) {
+                handleJob(req, res);
+            });
+
+        server.Post(
+            R"(/api/job/(\d+)/renew)",
+            [&](const httplib::Request& req, httplib::Response& res) {
+                handleRenew(req, res);
+            });
+
+        server.Post(
+            R"(/api/job/(\d+)/finish)",
+            [&](const httplib::Request& req, httplib::Response& res) {
+                handleFinish(req, res);
+            });
+
+        server.Post(
+            R"(/api/solution/(\d+))",
+            [&](const httplib::Request& req, httplib::Response& res) {
+                handleSolution(req, res);
+            });
+
+        server.Get(
+            "/api/incumbents",
+            [&](const httplib::Request&, httplib::Response& res) {
+                res.set_content(getIncumbents().dump(), "application/json");
+            });
+    }
+
+    void addJob(int testId, const std::string& solver, unsigned int seed, int budget) {
+        std::lock_guard lock(jobsMutex);
+        pendingJobs.emplace_back(nextJobId++, testId, solver, seed, budget);
+    }
+
+    // Blocks until every job has been finished
+    bool listen(const std::string& host, int port) {
+        {
+            std::lock_guard lock(jobsMutex);
+            spdlog::info("Serving {} jobs on {}:{}", pendingJobs.size(), host, port);
+        }
+
+        return server.listen(host, port);
+    }
+
+private:
+    void handleJob(const httplib::Request& req, httplib::Response& res) {
+        auto solver = req.get_param_value("solver");
+
+        std::lock_guard lock(jobsMutex);
+        requeueExpiredJobs();
+
+        auto it = std::ranges::find_if(pendingJobs, [&](const Job& job) { return job.solver == solver; });
+        if (it == pendingJobs.end()) {
+            // Workers that leave now could not pick up a job whose lease expires later, so they wait for it instead
+            if (auto retryAfter = getRetryAfter(solver)) {
+                res.status = 503;
+                res.set_header("Retry-After", std::to_string(*retryAfter));
+                return;
+            }
+
+            res.status = 204;
+            return;
+        }
+
+        Job job = *it;
+        pendingJobs.erase(it);
+
+        auto token = nextLeaseToken++;
+        runningJobs.emplace(job.id, Lease{job, token, std::chrono::steady_clock::now() + leaseDuration});
+
+        spdlog::info(
+            "[Job {}] Assigned test {} ({}, seed {}, budget {}) to {}",
+            job.id,
+            job.testId,
+            job.solver,
+            job.seed,
+            job.budget,
+            req.remote_addr);
+
+        nlohmann::json json{
+            {"job", job.toJson()},
+            {"lease", {{"token", token}, {"seconds", leaseDuration.count()}}},
+            {"incumbent", program.getBestScore(job.testId)}};
+        res.set_content(json.dump(), "application/json");
+    }
+
+    void handleRenew(const httplib::Request& req, httplib::Response& res) {
+        int jobId = std::stoi(req.matches[1].str());
+
+        auto token = parseLeaseToken(req, res);
+        if (!token) {
+            return;
+        }
+
+        std::lock_guard lock(jobsMutex);
+
+        auto it = runningJobs.find(jobId);
+        if (it == runningJobs.end() || it->second.token != *token) {
+            res.status = 409;
+            res.set_content(fmt::format("Lease {} of job {} has expired", *token, jobId), "text/plain");
+            return;
+        }
+
+        it->second.expiresAt = std::chrono::steady_clock::now() + leaseDuration;
+    }
+
+    void handleFinish(const httplib::Request& req, httplib::Response& res) {
+        int jobId = std::stoi(req.matches[1].str());
+
+        auto token = parseLeaseToken(req, res);
+        if (!token) {
+            return;
+        }
+
+        std::lock_guard lock(jobsMutex);
+
+        auto it = runningJobs.find(jobId);
+        if (it != runningJobs.end() && it->second.token == *token) {
+            runningJobs.erase(it);
+        } else if (it != runningJobs.end()) {
+            // The job was requeued and reassigned after this lease expired, the current lease stays
+            spdlog::warn(
+                "[Job {}] Ignoring finish of expired lease {}, lease {} is running",
+                jobId,
+                *token,
+                it->second.token);
+            return;
+        } else {
+            // The lease expired before the worker finished after all, a requeued copy nobody picked up is redundant
+            std::erase_if(pendingJobs, [&](const Job& job) { return job.id == jobId; });
+            spdlog::warn("[Job {}] Finished after lease {} expired", jobId, *token);
+        }
+
+        spdlog::info("[Job {}] Finished, {} pending, {} running", jobId, pendingJobs.size(), runningJobs.size());
+
+        if (pendingJobs.empty() && runningJobs.empty()) {
+            spdlog::info("All jobs finished");
+            server.stop();
+        }
+    }
+
+    void handleSolution(const httplib::Request& req, httplib::Response& res) {
+        int testId = std::stoi(req.matches[1].str());
+
+        auto it = tests.find(testId);
+        if (it == tests.end()) {
+            res.status = 404;
+            res.set_content(fmt::format("Test {} is not being solved", testId), "text/plain");
+            return;
+        }
+
+        const auto& test = it->second;
+
+        try {
+            auto actions = parseSolution(req.body);
+
+            if (actions.size() > static_cast<std::size_t>(test.noTurns)) {
+                res.status = 400;
+                res.set_content(fmt::format("{} actions exceed {} turns", actions.size(), test.noTurns), "text/plain");
+                return;
+            }
+
+            ReferenceState validator(test);
+            for (std::size_t i = 0; i < actions.size(); ++i) {
+                auto violation = validator.findViolation(*actions[i]);
+                if (violation) {
+                    res.status = 400;
+                    res.set_content(fmt::format("Turn {}: {}", i, *violation), "text/plain");
+                    return;
+                }
+
+                validator.apply(*actions[i]);
+            }
+
+            {
+                std::lock_guard lock(submitMutex);
+                program.submit(test, actions);
+            }
+        } catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content(e.what(), "text/plain");
+            return;
+        }
+
+        res.set_content(getIncumbents().dump(), "application/json");
+    }
+
+    static std::optional<std::uint64_t> parseLeaseToken(const httplib::Request& req, httplib::Response& res) {
+        auto param = req.get_param_value("lease");
+
+        std::uint64_t token = 0;
+        auto [end, error] = std::from_chars(param.data(), param.data() + param.size(), token);
+        if (error != std::errc() || end != param.data() + param.size()) {
+            res.status = 400;
+            res.set_content("Expected the lease token of the assignment", "text/plain");
+            return std::nullopt;
+        }
+
+        return token;
+    }
+
+    // Must be called with jobsMutex held
+    void requeueExpiredJobs() {
+        auto now = std::chrono::steady_clock::now();
+
+        std::vector<int> expiredJobIds;
+        for (const auto& [jobId, lease] : runningJobs) {
+            if (now >= lease.expiresAt) {
+                expiredJobIds.emplace_back(jobId);
+            }
+        }
+
+        for (int jobId : expiredJobIds) {
+            const auto& job = runningJobs.at(jobId).job;
+            spdlog::warn(
+                "[Job {}] Lease expired, requeueing test {} ({}, seed {})",
+                jobId,
+                job.testId,
+                job.solver,
+                job.seed);
+
+            pendingJobs.push_front(job);
+            runningJobs.erase(jobId);
+        }
+    }
+
+    // Seconds until the first lease of the solver's running jobs expires, capped so workers notice an early finish
+    // Must be called with jobsMutex held
+    std::optional<long long> getRetryAfter(const std::string& solver) const {
+        std::optional<std::chrono::steady_clock::time_point> firstExpiry;
+        for (const auto& [jobId, lease] : runningJobs) {
+            if (lease.job.solver == solver && (!firstExpiry || lease.expiresAt < *firstExpiry)) {
+                firstExpiry = lease.expiresAt;
+            }
+        }
+
+        if (!firstExpiry) {
+            return std::nullopt;
+        }
+
+        auto remaining = std::chrono::ceil<std::chrono::seconds>(*firstExpiry - std::chrono::steady_clock::now());
+        return std::clamp<long long>(remaining.count(), 1, 10);
+    }
+
+    nlohmann::json getIncumbents() {
+        auto incumbents = nlohmann::json::array();
+        for (const auto& [testId, score] : program.getBestScores()) {
+            incumbents.push_back({{"test_id", testId}, {"score", score}});
+        }
+
+        return {{"incumbents", incumbents}};
+    }
+};
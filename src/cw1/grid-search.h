@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -22,13 +24,73 @@ struct GridSearchParameter {
 class GridSearch {
     std::vector<GridSearchParameter> parameters;
 
+    unsigned int seed = 0;
+    std::size_t budget = 0;
+
 public:
     void addParameter(const std::string& name, double min, double max, double step) {
         parameters.emplace_back(name, min, max, step);
     }
 
+    // Visits the combinations in an order shuffled by the seed, 0 keeps the grid order
+    void setSeed(unsigned int newSeed) {
+        seed = newSeed;
+    }
+
+    // Caps the number of visited combinations, 0 visits all of them
+    void setBudget(std::size_t newBudget) {
+        budget = newBudget;
+    }
+
     template<typename F>
     void run(F&& func) {
+        if (seed == 0 && budget == 0) {
+            forEachCombination(func);
+            return;
+        }
+
+        std::vector<ankerl::unordered_dense::map<std::string, double>> combinations;
+        forEachCombination(
+            [&](const ankerl::unordered_dense::map<std::string, double>& namedValues) {
+                combinations.emplace_back(namedValues);
+            });
+
+        if (seed != 0) {
+            std::mt19937 rng(seed);
+            std::ranges::shuffle(combinations, rng);
+        }
+
+        if (budget > 0 && combinations.size() > budget) {
+            combinations.erase(combinations.begin() + budget, combinations.end());
+        }
+
+        for (const auto& namedValues : combinations) {
+            func(namedValues);
+        }
+    }
+
+    template<std::size_t N, typename F>
+    void runBatched(F&& func) {
+        std::vector<ankerl::unordered_dense::map<std::string, double>> batch;
+        batch.reserve(N);
+
+        run(
+            [&](const ankerl::unordered_dense::map<std::string, double>& namedValues) {
+                batch.emplace_back(namedValues);
+                if (batch.size() == N) {
+                    func(batch);
+                    batch.clear();
+                }
+            });
+
+        if (!batch.empty()) {
+            func(batch);
+        }
+    }
+
+private:
+    template<typename F>
+    void forEachCombination(F&& func) {
         std::size_t noParams = parameters.size();
 
         std::vector<double> values;
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+// A unit of work handed out by the coordinator, standalone runs use one job per selected test
+struct Job {
+    int id;
+    int testId;
+    std::string solver;
+    unsigned int seed;
+
+    // Solver-specific limit on the work to spend, 0 means no limit
+    int budget;
+
+    Job(int id, int testId, const std::string& solver, unsigned int seed, int budget)
+        : id(id),
+          testId(testId),
+          solver(solver),
+          seed(seed),
+          budget(budget) {}
+
+    nlohmann::json toJson() const {
+        return {{"id", id}, {"test_id", testId}, {"solver", solver}, {"seed", seed}, {"budget", budget}};
+    }
+
+    static Job fromJson(const nlohmann::json& json) {
+        return {
+            json.at("id").get<int>(),
+            json.at("test_id").get<int>(),
+            json.at("solver").get<std::string>(),
+            json.at("seed").get<unsigned int>(),
+            json.at("budget").get<int>()};
+    }
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <charconv>
+#include <string>
+#include <string_view>
+
+// Appends JSON fragments straight to an output buffer, byte-for-byte compatible with nlohmann::json::dump()
+
+inline void appendJsonNumber(std::string& out, long long value) {
+    char buffer[24];
+    auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, end);
+}
+
+inline void appendJsonString(std::string& out, std::string_view value) {
+    static constexpr char hexDigits[] = "0123456789abcdef";
+
+    out += '"';
+
+    std::size_t runStart = 0;
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        auto c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        out.append(value.data() + runStart, i - runStart);
+        runStart = i + 1;
+
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\b':
+                out += "\\b";
+                break;
+            case '\f':
+                out += "\\f";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                out += "\\u00";
+                out += hexDigits[c >> 4];
+                out += hexDigits[c & 0xf];
+                break;
+        }
+    }
+
+    out.append(value.data() + runStart, value.size() - runStart);
+    out += '"';
+}
@@ -0,0 +1,424 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include <ankerl/unordered_dense.h>
+
+#include <cw1/test.h>
+
+// Plans moves towards a target while avoiding monster attack radii
+// Each turn lands on a lattice point within speed, every landing point adds the attack of all living monsters
+// that cover it to the hero's fatigue, which permanently discounts all future gold
+//
+// The search is A* over landing points, with a sampled neighborhood of full- and half-speed steps in a fixed
+// number of directions, the straight step towards the target and points on the edge of the target's range
+// Paths are cached per (start, target, speed, reach, set of dead attackers), so rollouts that replan every turn
+// mostly hit the cache. A planner is not thread-safe, use one per thread.
+class PathPlanner {
+    struct Cost {
+        int turns;
+        long long danger;
+    };
+
+    struct Node {
+        Position position;
+        Cost cost;
+        long long danger;
+        int heuristic;
+        int parent;
+        bool closed;
+    };
+
+    struct QueueEntry {
+        Cost estimate;
+        int heuristic;
+        int node;
+    };
+
+    struct CacheKey {
+        int startX;
+        int startY;
+        int targetX;
+        int targetY;
+        int speed;
+        int reach;
+        std::uint64_t deadHash;
+
+        bool operator==(const CacheKey& other) const = default;
+    };
+
+    struct CacheKeyHash {
+        using is_avalanching = void;
+
+        std::uint64_t operator()(const CacheKey& key) const noexcept {
+            ankerl::unordered_dense::hash<std::uint64_t> hash;
+
+            std::uint64_t result = hash(pack(key.startX, key.startY));
+            result = hash(result ^ pack(key.targetX, key.targetY));
+            result = hash(result ^ pack(key.speed, key.reach));
+            return hash(result ^ key.deadHash);
+        }
+
+        static std::uint64_t pack(int high, int low) {
+            return static_cast<std::uint64_t>(static_cast<std::uint32_t>(high)) << 32 | static_cast<std::uint32_t>(low);
+        }
+    };
+
+    static constexpr int noDirections = 16;
+    static constexpr std::size_t maxCacheSize = 1 << 16;
+
+    const Test& test;
+
+    // Weight of a single turn in units of accumulated attack, 0 means fewest turns first with danger as tie-breaker
+    long long turnCost;
+    int maxExpansions;
+
+    int bucketSize;
+    int noBucketsX;
+    int noBucketsY;
+    std::vector<std::vector<int>> buckets;
+
+    std::vector<int> attackerIds;
+    std::vector<std::uint64_t> monsterKeys;
+
+    ankerl::unordered_dense::map<int, std::vector<Position>> stepsBySpeed;
+    ankerl::unordered_dense::map<CacheKey, std::vector<Position>, CacheKeyHash> cache;
+
+    std::vector<Node> nodes;
+    ankerl::unordered_dense::map<std::uint64_t, int> nodeIndices;
+
+    std::vector<Position> path;
+
+public:
+    explicit PathPlanner(const Test& test, long long turnCost = 0, int maxExpansions = 1024)
+        : test(test),
+          turnCost(turnCost),
+          maxExpansions(maxExpansions),
+          bucketSize(32),
+          noBucketsX(test.width / 32 + 1),
+          noBucketsY(test.height / 32 + 1),
+          buckets(noBucketsX * noBucketsY) {
+        std::mt19937_64 rng(test.id);
+        monsterKeys.reserve(test.monsters.size());
+
+        for (const auto& monster : test.monsters) {
+            monsterKeys.emplace_back(rng());
+
+            if (monster.attack == 0) {
+                continue;
+            }
+
+            attackerIds.emplace_back(monster.id);
+
+            int minBucketX = std::max<long long>(0, (monster.position.x - monster.range) / bucketSize);
+            int maxBucketX = std::min<long long>(noBucketsX - 1, (monster.position.x + monster.range) / bucketSize);
+            int minBucketY = std::max<long long>(0, (monster.position.y - monster.range) / bucketSize);
+            int maxBucketY = std::min<long long>(noBucketsY - 1, (monster.position.y + monster.range) / bucketSize);
+
+            for (int bucketX = minBucketX; bucketX <= maxBucketX; ++bucketX) {
+                for (int bucketY = minBucketY; bucketY <= maxBucketY; ++bucketY) {
+                    buckets[bucketX * noBucketsY + bucketY].emplace_back(monster.id);
+                }
+            }
+        }
+    }
+
+    bool hasAttackers() const {
+        return !attackerIds.empty();
+    }
+
+    // Total attack the hero takes when ending a turn on (x, y)
+    template<typename IsAlive>
+    long long dangerAt(int x, int y, IsAlive&& isAlive) const {
+        long long danger = 0;
+
+        for (int id : buckets[(x / bucketSize) * noBucketsY + y / bucketSize]) {
+            const auto& monster = test.monsters[id];
+            if (isAlive(id) && monster.position.isInRange(x, y, monster.range)) {
+                danger += monster.attack;
+            }
+        }
+
+        return danger;
+    }
+
+    // Landing points of each turn until the hero is within reach of the target, empty if it already is
+    // The path is owned by the planner and only valid until the next call
+    template<typename IsAlive>
+    const std::vector<Position>& plan(
+        const Position& start,
+        int speed,
+        const Position& target,
+        int reach,
+        IsAlive&& isAlive) {
+        if (target.isInRange(start, reach)) {
+            path.clear();
+            return path;
+        }
+
+        // Without attackers every path is free and the straight line takes the fewest turns already
+        if (!hasAttackers() || speed <= 0) {
+            path = planStraight(start, speed, target, reach);
+            return path;
+        }
+
+        std::uint64_t deadHash = 0;
+        for (int id : attackerIds) {
+            if (!isAlive(id)) {
+                deadHash ^= monsterKeys[id];
+            }
+        }
+
+        CacheKey key{start.x, start.y, target.x, target.y, speed, reach, deadHash};
+        if (auto it = cache.find(key); it != cache.end()) {
+            return it->second;
+        }
+
+        path = search(start, speed, target, reach, isAlive);
+
+        if (cache.size() + path.size() > maxCacheSize) {
+            cache.clear();
+        }
+
+        // Suffixes of the path are good paths from the intermediate landing points too
+        for (std::size_t i = 0; i < path.size(); ++i) {
+            const auto& from = i == 0 ? start : path[i - 1];
+            key.startX = from.x;
+            key.startY = from.y;
+            cache.emplace(key, std::vector<Position>(path.begin() + i, path.end()));
+        }
+
+        return path;
+    }
+
+    template<typename IsAlive>
+    Position nextPosition(
+        const Position& start,
+        int speed,
+        const Position& target,
+        int reach,
+        IsAlive&& isAlive) {
+        if (!hasAttackers()) {
+            return start.positionTowards(target, speed);
+        }
+
+        const auto& steps = plan(start, speed, target, reach, isAlive);
+        return steps.empty() ? start : steps.front();
+    }
+
+private:
+    std::vector<Position> planStraight(const Position& start, int speed, const Position& target, int reach) const {
+        std::vector<Position> path;
+        Position current = start;
+
+        while (!target.isInRange(current, reach)) {
+            auto next = current.positionTowards(target, speed);
+            if (next.x == current.x && next.y == current.y) {
+                break;
+            }
+
+            path.emplace_back(next);
+            current = next;
+        }
+
+        return path;
+    }
+
+    template<typename IsAlive>
+    std::vector<Position> search(
+        const Position& start,
+        int speed,
+        const Position& target,
+        int reach,
+        IsAlive&& isAlive) {
+        const auto& steps = getSteps(speed);
+        auto finishes = getFinishes(target, reach);
+
+        nodes.clear();
+        nodeIndices.clear();
+
+        auto compare = [&](const QueueEntry& a, const QueueEntry& b) {
+            if (isBetter(a.estimate, b.estimate)) {
+                return false;
+            }
+
+            if (isBetter(b.estimate, a.estimate)) {
+                return true;
+            }
+
+            // Among equal estimates, prefer nodes closer to the target so ties don't flood the frontier
+            return a.heuristic > b.heuristic;
+        };
+
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, decltype(compare)> open(compare);
+
+        auto visit = [&](const Position& position, int parent) {
+            if (position.x < 0 || position.x > test.width || position.y < 0 || position.y > test.height) {
+                return;
+            }
+
+            Cost cost{0, 0};
+            long long danger = 0;
+
+            if (parent >= 0) {
+                danger = dangerAt(position.x, position.y, isAlive);
+                cost = {nodes[parent].cost.turns + 1, nodes[parent].cost.danger + danger};
+            }
+
+            auto [it, inserted] = nodeIndices.try_emplace(getNodeKey(position), static_cast<int>(nodes.size()));
+            if (inserted) {
+                nodes.push_back({position, cost, danger, estimateTurns(position, speed, target, reach), parent, false});
+            } else {
+                auto& node = nodes[it->second];
+                if (node.closed || !isBetter(cost, node.cost)) {
+                    return;
+                }
+
+                node.cost = cost;
+                node.parent = parent;
+            }
+
+            const auto& node = nodes[it->second];
+            open.push({{node.cost.turns + node.heuristic, node.cost.danger}, node.heuristic, it->second});
+        };
+
+        visit(start, -1);
+
+        int expansions = 0;
+
+        while (!open.empty()) {
+            auto entry = open.top();
+            open.pop();
+
+            auto& node = nodes[entry.node];
+            if (node.closed) {
+                continue;
+            }
+
+            node.closed = true;
+
+            if (target.isInRange(node.position, reach)) {
+                return reconstructPath(entry.node);
+            }
+
+            if (++expansions > maxExpansions) {
+                break;
+            }
+
+            Position position = node.position;
+
+            for (const auto& step : steps) {
+                visit({position.x + step.x, position.y + step.y}, entry.node);
+            }
+
+            visit(position.positionTowards(target, speed), entry.node);
+
+            if (target.distanceTo(position) <= std::pow(speed + reach, 2)) {
+                for (const auto& finish : finishes) {
+                    if (position.isInRange(finish, speed)) {
+                        visit(finish, entry.node);
+                    }
+                }
+            }
+        }
+
+        return planStraight(start, speed, target, reach);
+    }
+
+    std::vector<Position> reconstructPath(int node) const {
+        std::vector<Position> path;
+        while (nodes[node].parent >= 0) {
+            path.emplace_back(nodes[node].position);
+            node = nodes[node].parent;
+        }
+
+        std::ranges::reverse(path);
+        return path;
+    }
+
+    bool isBetter(const Cost& a, const Cost& b) const {
+        if (turnCost == 0) {
+            return a.turns < b.turns || (a.turns == b.turns && a.danger < b.danger);
+        }
+
+        return a.turns * turnCost + a.danger < b.turns * turnCost + b.danger;
+    }
+
+    // Lower bound on the turns needed to get within reach, admissible because no step covers more than speed
+    static int estimateTurns(const Position& position, int speed, const Position& target, int reach) {
+        double distance = std::sqrt(static_cast<double>(target.distanceTo(position)));
+        if (distance <= reach) {
+            return 0;
+        }
+
+        return std::max(1, static_cast<int>(std::ceil((distance - reach) / speed - 1e-9)));
+    }
+
+    std::uint64_t getNodeKey(const Position& position) const {
+        return static_cast<std::uint64_t>(position.x) * (test.height + 1) + position.y;
+    }
+
+    const std::vector<Position>& getSteps(int speed) {
+        auto it = stepsBySpeed.find(speed);
+        if (it != stepsBySpeed.end()) {
+            return it->second;
+        }
+
+        std::vector<Position> steps;
+        for (int radius : {speed, (speed + 1) / 2}) {
+            for (const auto& step : getCirclePoints(radius)) {
+                if (std::ranges::find_if(steps, [&](const Position& p) { return p.x == step.x && p.y == step.y; })
+                    == steps.end()) {
+                    steps.emplace_back(step);
+                }
+            }
+        }
+
+        return stepsBySpeed.emplace(speed, steps).first->second;
+    }
+
+    // Points just inside the target's reach in evenly spread directions, the straight step is tried for every node
+    std::vector<Position> getFinishes(const Position& target, int reach) const {
+        std::vector<Position> finishes;
+        for (const auto& point : getCirclePoints(reach)) {
+            finishes.emplace_back(target.x + point.x, target.y + point.y);
+        }
+
+        return finishes;
+    }
+
+    // Lattice points at most radius away from the origin, as far out as possible in evenly spread directions
+    static std::vector<Position> getCirclePoints(int radius) {
+        std::vector<Position> points;
+        points.reserve(noDirections);
+
+        for (int i = 0; i < noDirections; ++i) {
+            double angle = 2.0 * std::numbers::pi * i / noDirections;
+            int x = static_cast<int>(std::round(radius * std::cos(angle)));
+            int y = static_cast<int>(std::round(radius * std::sin(angle)));
+
+            while (x * x + y * y > radius * radius) {
+                if (std::abs(x) >= std::abs(y)) {
+                    x -= x > 0 ? 1 : -1;
+                } else {
+                    y -= y > 0 ? 1 : -1;
+                }
+            }
+
+            if ((x != 0 || y != 0)
+                && std::ranges::find_if(points, [&](const Position& p) { return p.x == x && p.y == y; })
+                       == points.end()) {
+                points.emplace_back(x, y);
+            }
+        }
+
+        return points;
+    }
+};
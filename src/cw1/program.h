@@ -1,10 +1,18 @@
 #pragma once
 
+#include <algorithm>
+#include <charconv>
 #include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <filesystem>
 #include <locale>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <stop_token>
 #include <string>
 #include <thread>
 #include <vector>
@@ -12,16 +20,21 @@
 #include <ankerl/unordered_dense.h>
 #include <fmt/format.h>
 #include <nlohmann/json.hpp>
+#include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_for_each.h>
 #include <spdlog/spdlog.h>
 
 #include <cw1/config.h>
+#include <cw1/job.h>
 #include <cw1/test.h>
 #include <cw1/solution.h>
+#include <cw1/solution-io.h>
 
 #define CPPHTTPLIB_OPENSSL_SUPPORT
 #include <httplib/httplib.h>
 
 class Program {
+    std::optional<std::string> coordinatorUrl;
     httplib::Client httpClient;
 
     ankerl::unordered_dense::map<int, int> bestScores;
@@ -29,7 +42,23 @@ class Program {
 
 public:
     Program()
-        : httpClient("https://codeweekend.dev:3721") {
+        : coordinatorUrl(getCoordinatorUrl()),
+          httpClient(coordinatorUrl.value_or("https://codeweekend.dev:3721")) {
+        // Workers only talk to the coordinator, which owns the scoreboard and all submissions
+        if (isWorker()) {
+            auto incumbentsResponse = httpClient.Get("/api/incumbents");
+            if (!incumbentsResponse) {
+                spdlog::error(
+                    "Cannot retrieve incumbents from {}: {}",
+                    *coordinatorUrl,
+                    httplib::to_string(incumbentsResponse.error()));
+                std::exit(1);
+            }
+
+            updateIncumbents(nlohmann::json::parse(incumbentsResponse->body));
+            return;
+        }
+
         httpClient.set_bearer_token_auth(getApiToken());
 
         auto scoreboardResponse = httpClient.Get("/api/scoreboard");
@@ -56,68 +85,65 @@ public:
         }
     }
 
-    std::vector<Test> parseArgs(int argc, char* argv[]) {
+    static std::vector<Test> parseArgs(int argc, char* argv[]) {
         std::locale::global(std::locale("en_US.UTF-8"));
+        return parseTestArgs(argc, argv);
+    }
 
-        std::vector<int> orderedIds;
-        ankerl::unordered_dense::set<int> seenIds;
+    bool isWorker() const {
+        return coordinatorUrl.has_value();
+    }
 
-        for (int i = 1; i < argc; ++i) {
-            std::string arg(argv[i]);
+    // Best known score for a test, solvers can use it to prune rollouts that cannot improve on it
+    int getBestScore(int testId) {
+        std::lock_guard lock(bestScoresMutex);
+        return bestScores.contains(testId) ? bestScores[testId] : 0;
+    }
 
-            auto rangeSeparator = arg.find('-');
-            if (rangeSeparator != std::string::npos) {
-                int lhs = std::stoi(arg.substr(0, rangeSeparator));
-                int rhs = std::stoi(arg.substr(rangeSeparator + 1));
+    ankerl::unordered_dense::map<int, int> getBestScores() {
+        std::lock_guard lock(bestScoresMutex);
+        return bestScores;
+    }
 
-                for (int j = lhs; j <= rhs; ++j) {
-                    if (!seenIds.contains(j)) {
-                        orderedIds.emplace_back(j);
-                        seenIds.emplace(j);
-                    }
-                }
-            } else {
-                int id = std::stoi(arg);
-                if (!seenIds.contains(id)) {
-                    orderedIds.emplace_back(id);
-                    seenIds.emplace(id);
-                }
-            }
-        }
+    // Solves the tests given on the command line, or jobs pulled from the coordinator when running as a worker
+    template<typename F>
+    void run(int argc, char* argv[], F&& solve) {
+        auto solver = std::filesystem::path(argv[0]).stem().string();
 
-        auto allTests = getAllTests();
-        spdlog::info("Test count: {}", allTests.size());
+        if (!isWorker()) {
+            auto tests = parseArgs(argc, argv);
 
-        if (orderedIds.empty()) {
-            orderedIds.reserve(allTests.size());
-            for (const auto& test : allTests) {
-                orderedIds.emplace_back(test.id);
-            }
-        }
+            tbb::parallel_for_each(
+                tests,
+                [&](const Test& test) {
+                    solve(test, Job(0, test.id, solver, 0, 0));
+                });
 
-        std::vector<Test> selectedTests;
-        selectedTests.reserve(orderedIds.size());
+            return;
+        }
 
-        std::vector<int> selectedTestIds;
-        selectedTestIds.reserve(orderedIds.size());
+        std::locale::global(std::locale("en_US.UTF-8"));
 
-        for (int id : orderedIds) {
-            if (id < 1 || id > allTests.size()) {
-                spdlog::warn("{} is not a valid test id", id);
-                continue;
-            }
+        auto tests = getAllTests();
+        std::size_t noThreads = std::max(1u, std::thread::hardware_concurrency());
 
-            selectedTests.emplace_back(allTests[id - 1]);
-            selectedTestIds.emplace_back(id);
-        }
+        spdlog::info("Pulling {} jobs from {} on {} threads", solver, *coordinatorUrl, noThreads);
 
-        if (selectedTests.empty()) {
-            spdlog::error("No tests to solve");
-            std::exit(1);
-        }
+        tbb::parallel_for(
+            std::size_t(0),
+            noThreads,
+            [&](std::size_t) {
+                while (auto assignment = fetchJob(solver)) {
+                    LeaseGuard leaseGuard(*this, *assignment);
 
-        spdlog::info("Solving ({}): {}", selectedTests.size(), spdlog::fmt_lib::join(selectedTestIds, " "));
-        return selectedTests;
+                    const auto& job = assignment->job;
+                    if (job.testId < 1 || job.testId > static_cast<int>(tests.size())) {
+                        spdlog::warn("[Job {}] {} is not a valid test id", job.id, job.testId);
+                    } else {
+                        solve(tests[job.testId - 1], job);
+                    }
+                }
+            });
     }
 
     void logStart(const Test& test) const {
@@ -136,23 +162,31 @@ public:
             action->apply(validator);
         }
 
-        if (bestScores.contains(test.id) && bestScores[test.id] >= validator.gold) {
+        std::optional<int> bestScore;
+
+        {
+            std::lock_guard lock(bestScoresMutex);
+            if (bestScores.contains(test.id)) {
+                bestScore = bestScores[test.id];
+            }
+        }
+
+        if (bestScore && *bestScore >= validator.gold) {
             return;
         }
 
-        auto oldScore = bestScores.contains(test.id) ? fmt::format("{:L}", bestScores[test.id]) : "no score";
-        spdlog::info("[Test {}] Submitting {} actions: {} -> {:L}", test.id, actions.size(), oldScore, validator.gold);
+        auto oldScore = bestScore ? fmt::format("{:L}", *bestScore) : "no score";
 
-        std::vector<nlohmann::json> moves;
-        moves.reserve(actions.size());
-        for (const auto& action : actions) {
-            moves.emplace_back(action->toJson());
+        if (isWorker()) {
+            spdlog::info("[Test {}] Pushing {} actions: {} -> {:L}", test.id, actions.size(), oldScore, validator.gold);
+            pushSolution(test, actions);
+            return;
         }
 
-        nlohmann::json solution{{"moves", moves}};
+        spdlog::info("[Test {}] Submitting {} actions: {} -> {:L}", test.id, actions.size(), oldScore, validator.gold);
 
         httplib::MultipartFormDataItems formData;
-        formData.emplace_back("file", solution.dump(), "submission.json", "application/json");
+        formData.emplace_back("file", serializeSolution(actions), "submission.json", "application/json");
 
         auto submitResponse = httpClient.Post(fmt::format("/api/submit/{}", test.id), formData);
         if (!submitResponse) {
@@ -197,4 +231,174 @@ public:
             std::this_thread::sleep_for(std::chrono::seconds(1));
         }
     }
+
+private:
+    // A job together with the lease the coordinator assigned it under
+    struct Assignment {
+        Job job;
+        std::uint64_t lease;
+        std::chrono::seconds leaseDuration;
+    };
+
+    // Renews the lease in the background while the job is solved and reports the finish when it goes out of scope,
+    // also when the solver throws, so the coordinator only hands the job out again if this worker is gone
+    class LeaseGuard {
+        Program& program;
+        const Assignment& assignment;
+        std::jthread renewer;
+
+    public:
+        LeaseGuard(Program& program, const Assignment& assignment)
+            : program(program),
+              assignment(assignment),
+              renewer([this](std::stop_token stopToken) { renewUntilStopped(stopToken); }) {}
+
+        ~LeaseGuard() {
+            renewer.request_stop();
+            renewer.join();
+
+            program.finishJob(assignment);
+        }
+
+    private:
+        void renewUntilStopped(std::stop_token stopToken) {
+            auto interval = std::max(std::chrono::seconds(1), assignment.leaseDuration / 3);
+
+            std::mutex mutex;
+            std::condition_variable_any stopped;
+            std::unique_lock lock(mutex);
+
+            while (!stopped.wait_for(lock, stopToken, interval, [&] { return stopToken.stop_requested(); })) {
+                if (!program.renewLease(assignment)) {
+                    return;
+                }
+            }
+        }
+    };
+
+    std::optional<Assignment> fetchJob(const std::string& solver) {
+        bool waiting = false;
+
+        while (true) {
+            auto jobResponse = httpClient.Get(fmt::format("/api/job?solver={}", solver));
+            if (!jobResponse) {
+                // The coordinator stops as soon as the last leased job is finished by another worker
+                if (waiting) {
+                    spdlog::info("Coordinator stopped while waiting for leased jobs");
+                } else {
+                    spdlog::warn("Cannot retrieve job: {}", httplib::to_string(jobResponse.error()));
+                }
+
+                return std::nullopt;
+            }
+
+            // Every remaining job is leased to another worker, one of them may still be requeued
+            if (jobResponse->status == 503) {
+                std::this_thread::sleep_for(std::chrono::seconds(getRetryAfter(*jobResponse)));
+
+                waiting = true;
+                continue;
+            }
+
+            // No content means the coordinator has run out of jobs for this solver
+            if (jobResponse->status != 200) {
+                return std::nullopt;
+            }
+
+            auto json = nlohmann::json::parse(jobResponse->body);
+            const auto& lease = json.at("lease");
+
+            Assignment assignment{
+                Job::fromJson(json.at("job")),
+                lease.at("token").get<std::uint64_t>(),
+                std::chrono::seconds(lease.at("seconds").get<long long>())};
+
+            {
+                std::lock_guard lock(bestScoresMutex);
+                bestScores[assignment.job.testId] = json.at("incumbent").get<int>();
+            }
+
+            return assignment;
+        }
+    }
+
+    // Seconds to wait before asking for a job again, proxies or older coordinators may not send a usable header
+    static int getRetryAfter(const httplib::Response& response) {
+        auto header = response.get_header_value("Retry-After");
+
+        int seconds = 0;
+        auto [end, error] = std::from_chars(header.data(), header.data() + header.size(), seconds);
+        if (error != std::errc() || end != header.data() + header.size()) {
+            return 5;
+        }
+
+        return std::clamp(seconds, 1, 60);
+    }
+
+    // False once the lease is lost, the job has been requeued and renewing it again cannot succeed
+    bool renewLease(const Assignment& assignment) {
+        const auto& job = assignment.job;
+
+        auto renewResponse = httpClient.Post(
+            fmt::format("/api/job/{}/renew?lease={}", job.id, assignment.lease),
+            "",
+            "application/json");
+
+        if (!renewResponse) {
+            spdlog::warn("[Job {}] Cannot renew lease: {}", job.id, httplib::to_string(renewResponse.error()));
+            return true;
+        }
+
+        if (renewResponse->status != 200) {
+            spdlog::warn("[Job {}] Lost lease, the job will be solved again: {}", job.id, renewResponse->body);
+            return false;
+        }
+
+        return true;
+    }
+
+    void finishJob(const Assignment& assignment) {
+        const auto& job = assignment.job;
+
+        auto finishResponse = httpClient.Post(
+            fmt::format("/api/job/{}/finish?lease={}", job.id, assignment.lease),
+            "",
+            "application/json");
+
+        if (!finishResponse) {
+            spdlog::warn("[Job {}] Cannot report finish: {}", job.id, httplib::to_string(finishResponse.error()));
+            return;
+        }
+
+        if (finishResponse->status != 200) {
+            spdlog::warn("[Job {}] Coordinator rejected finish: {}", job.id, finishResponse->body);
+        }
+    }
+
+    void pushSolution(const Test& test, const std::vector<std::unique_ptr<Action>>& actions) {
+        auto pushResponse = httpClient.Post(
+            fmt::format("/api/solution/{}", test.id),
+            serializeSolution(actions),
+            "application/json");
+
+        if (!pushResponse) {
+            spdlog::warn("[Test {}] Cannot push solution: {}", test.id, httplib::to_string(pushResponse.error()));
+            return;
+        }
+
+        if (pushResponse->status != 200) {
+            spdlog::warn("[Test {}] Coordinator rejected solution: {}", test.id, pushResponse->body);
+            return;
+        }
+
+        updateIncumbents(nlohmann::json::parse(pushResponse->body));
+    }
+
+    void updateIncumbents(const nlohmann::json& json) {
+        std::lock_guard lock(bestScoresMutex);
+
+        for (const auto& incumbent : json["incumbents"]) {
+            bestScores[incumbent["test_id"].get<int>()] = incumbent["score"].get<int>();
+        }
+    }
 };
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cmath>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <cw1/solution.h>
+#include <cw1/test.h>
+
+// Line-by-line port of State and the actions in gui/src/core/solution.ts, kept deliberately unoptimized
+// All arithmetic happens on doubles like it does in JavaScript, so it can serve as the ground truth
+// the optimized simulators are checked against
+struct ReferenceState {
+    const Test& test;
+
+    double x;
+    double y;
+
+    double speed;
+    double power;
+    double range;
+
+    double gold;
+    double exp;
+    double level;
+
+    double fatigue;
+
+    std::vector<double> monsterHp;
+
+    explicit ReferenceState(const Test& test)
+        : test(test),
+          x(test.startPosition.x),
+          y(test.startPosition.y),
+          speed(test.hero.baseSpeed),
+          power(test.hero.basePower),
+          range(test.hero.baseRange),
+          gold(0),
+          exp(0),
+          level(0),
+          fatigue(0) {
+        for (const auto& monster : test.monsters) {
+            monsterHp.emplace_back(static_cast<double>(monster.hp));
+        }
+    }
+
+    void apply(const Action& action) {
+        if (auto moveAction = dynamic_cast<const MoveAction*>(&action)) {
+            x = moveAction->x;
+            y = moveAction->y;
+        } else if (auto attackAction = dynamic_cast<const AttackAction*>(&action)) {
+            applyAttack(attackAction->target);
+        }
+
+        applyAttacks();
+    }
+
+    // Returns why the judge would reject the action, the GUI itself does not enforce these rules
+    std::optional<std::string> findViolation(const Action& action) const {
+        if (auto moveAction = dynamic_cast<const MoveAction*>(&action)) {
+            if (moveAction->x < 0 || moveAction->x > test.width || moveAction->y < 0 || moveAction->y > test.height) {
+                return fmt::format("move to ({}, {}) is outside the map", moveAction->x, moveAction->y);
+            }
+
+            if (!isInRange(moveAction->x, moveAction->y, speed)) {
+                return fmt::format("move to ({}, {}) exceeds speed {}", moveAction->x, moveAction->y, speed);
+            }
+        } else if (auto attackAction = dynamic_cast<const AttackAction*>(&action)) {
+            if (attackAction->target < 0 || attackAction->target >= static_cast<int>(test.monsters.size())) {
+                return fmt::format("attack on unknown monster {}", attackAction->target);
+            }
+
+            if (monsterHp[attackAction->target] <= 0) {
+                return fmt::format("attack on dead monster {}", attackAction->target);
+            }
+
+            const auto& monster = test.monsters[attackAction->target];
+            if (!isInRange(monster.position.x, monster.position.y, range)) {
+                return fmt::format("monster {} is out of range {}", attackAction->target, range);
+            }
+        }
+
+        return std::nullopt;
+    }
+
+private:
+    bool isInRange(double otherX, double otherY, double maxDistance) const {
+        return std::pow(otherX - x, 2) + std::pow(otherY - y, 2) <= std::pow(maxDistance, 2);
+    }
+
+    void applyAttacks() {
+        for (const auto& monster : test.monsters) {
+            if (monsterHp[monster.id] > 0 && isInRange(monster.position.x, monster.position.y, monster.range)) {
+                fatigue += monster.attack;
+            }
+        }
+    }
+
+    void applyAttack(int monsterId) {
+        monsterHp[monsterId] -= power;
+
+        if (monsterHp[monsterId] <= 0) {
+            const auto& monster = test.monsters[monsterId];
+            gold += std::floor(static_cast<double>(monster.gold) * (1000 / (1000 + fatigue)) + 1e-6);
+            exp += monster.exp;
+
+            double oldLevel = level;
+
+            while (true) {
+                double requiredExp = 1000 + (level + 1) * level * 50;
+                if (exp < requiredExp) {
+                    break;
+                }
+
+                exp -= requiredExp;
+                level++;
+            }
+
+            if (level != oldLevel) {
+                speed = calculateStat(level, test.hero.baseSpeed, test.hero.coeffSpeed);
+                power = calculateStat(level, test.hero.basePower, test.hero.coeffPower);
+                range = calculateStat(level, test.hero.baseRange, test.hero.coeffRange);
+            }
+        }
+    }
+
+    static double calculateStat(double level, double base, double coeff) {
+        return std::floor(base * (1 + level * (coeff / 100)) + 1e-6);
+    }
+};
@@ -0,0 +1,509 @@
+#pragma once
+
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include <cw1/solution.h>
+
+// Writes {"moves":[...]} directly from the actions, output is identical to dumping the toJson() DOM
+inline void serializeSolution(std::string& out, const std::vector<std::unique_ptr<Action>>& actions) {
+    // Moves are ~40 bytes without a comment, reserving up front avoids regrowing the buffer mid-write
+    out.reserve(out.size() + 16 + actions.size() * 48);
+
+    out += "{\"moves\":[";
+
+    for (std::size_t i = 0; i < actions.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+
+        actions[i]->writeJson(out);
+    }
+
+    out += "]}";
+}
+
+inline std::string serializeSolution(const std::vector<std::unique_ptr<Action>>& actions) {
+    std::string out;
+    serializeSolution(out, actions);
+    return out;
+}
+
+// Writes the same bytes as serializeSolution() through a buffer that is flushed to the descriptor whenever it fills,
+// so memory use does not grow with the solution
+inline void writeSolution(
+    int fd,
+    const std::vector<std::unique_ptr<Action>>& actions,
+    std::size_t bufferSize = 64 * 1024) {
+    std::string buffer;
+    buffer.reserve(bufferSize);
+
+    auto flush = [&] {
+        std::size_t written = 0;
+        while (written < buffer.size()) {
+            auto result = ::write(fd, buffer.data() + written, buffer.size() - written);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                throw std::runtime_error(fmt::format("Cannot write solution: {}", std::strerror(errno)));
+            }
+
+            written += result;
+        }
+
+        buffer.clear();
+    };
+
+    buffer += "{\"moves\":[";
+
+    for (std::size_t i = 0; i < actions.size(); ++i) {
+        if (i > 0) {
+            buffer += ',';
+        }
+
+        actions[i]->writeJson(buffer);
+
+        // An action with a long comment may overshoot, the buffer then grows once instead of splitting the action
+        if (buffer.size() >= bufferSize) {
+            flush();
+        }
+    }
+
+    buffer += "]}";
+    flush();
+}
+
+// Hand-rolled parser for solutions written by serializeSolution(), nlohmann::json or the GUI
+// Keys may appear in any order and unknown keys are skipped, so hand-edited files load as well
+class SolutionParser {
+    std::string_view input;
+    std::size_t pos = 0;
+
+public:
+    explicit SolutionParser(std::string_view input)
+        : input(input) {}
+
+    std::vector<std::unique_ptr<Action>> parse() {
+        std::vector<std::unique_ptr<Action>> actions;
+        bool seenMoves = false;
+
+        expect('{');
+        if (!consume('}')) {
+            do {
+                auto key = parseString();
+                expect(':');
+
+                if (key == "moves") {
+                    parseMoves(actions);
+                    seenMoves = true;
+                } else {
+                    skipValue();
+                }
+            } while (consume(','));
+
+            expect('}');
+        }
+
+        skipWhitespace();
+        if (pos != input.size()) {
+            fail("Unexpected trailing characters");
+        }
+
+        if (!seenMoves) {
+            fail("Missing \"moves\" key");
+        }
+
+        return actions;
+    }
+
+private:
+    void parseMoves(std::vector<std::unique_ptr<Action>>& actions) {
+        expect('[');
+        if (consume(']')) {
+            return;
+        }
+
+        do {
+            actions.emplace_back(parseMove());
+        } while (consume(','));
+
+        expect(']');
+    }
+
+    std::unique_ptr<Action> parseMove() {
+        std::string type;
+        std::string comment;
+        std::optional<int> targetX;
+        std::optional<int> targetY;
+        std::optional<int> targetId;
+
+        expect('{');
+        if (!consume('}')) {
+            do {
+                auto key = parseString();
+                expect(':');
+
+                if (key == "type") {
+                    type = parseString();
+                } else if (key == "comment") {
+                    comment = parseString();
+                } else if (key == "target_x") {
+                    targetX = parseInteger();
+                } else if (key == "target_y") {
+                    targetY = parseInteger();
+                } else if (key == "target_id") {
+                    targetId = parseInteger();
+                } else {
+                    skipValue();
+                }
+            } while (consume(','));
+
+            expect('}');
+        }
+
+        if (type == "move") {
+            if (!targetX || !targetY) {
+                fail("Move is missing target_x or target_y");
+            }
+
+            return std::make_unique<MoveAction>(*targetX, *targetY, comment);
+        }
+
+        if (type == "attack") {
+            if (!targetId) {
+                fail("Attack is missing target_id");
+            }
+
+            return std::make_unique<AttackAction>(*targetId, comment);
+        }
+
+        fail(fmt::format("Unknown move type \"{}\"", type));
+    }
+
+    std::string parseString() {
+        skipWhitespace();
+        if (pos >= input.size() || input[pos] != '"') {
+            fail("Expected string");
+        }
+
+        ++pos;
+
+        std::string out;
+
+        while (true) {
+            std::size_t runStart = pos;
+            while (pos < input.size() && input[pos] != '"' && input[pos] != '\\') {
+                if (static_cast<unsigned char>(input[pos]) < 0x20) {
+                    fail("Control character in string");
+                }
+
+                ++pos;
+            }
+
+            out.append(input.data() + runStart, pos - runStart);
+
+            if (pos >= input.size()) {
+                fail("Unterminated string");
+            }
+
+            if (input[pos++] == '"') {
+                return out;
+            }
+
+            if (pos >= input.size()) {
+                fail("Unterminated escape sequence");
+            }
+
+            char escape = input[pos++];
+            switch (escape) {
+                case '"':
+                case '\\':
+                case '/':
+                    out += escape;
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                    appendCodePoint(out, parseUnicodeEscape());
+                    break;
+                default:
+                    fail("Invalid escape sequence");
+            }
+        }
+    }
+
+    std::uint32_t parseUnicodeEscape() {
+        std::uint32_t codePoint = parseHex4();
+
+        if (codePoint >= 0xd800 && codePoint <= 0xdbff) {
+            if (input.substr(pos, 2) != "\\u") {
+                fail("Unpaired surrogate in string");
+            }
+
+            pos += 2;
+
+            std::uint32_t low = parseHex4();
+            if (low < 0xdc00 || low > 0xdfff) {
+                fail("Invalid low surrogate in string");
+            }
+
+            codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+        } else if (codePoint >= 0xdc00 && codePoint <= 0xdfff) {
+            fail("Unpaired surrogate in string");
+        }
+
+        return codePoint;
+    }
+
+    std::uint32_t parseHex4() {
+        if (pos + 4 > input.size()) {
+            fail("Truncated unicode escape");
+        }
+
+        std::uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = input[pos++];
+            value <<= 4;
+
+            if (c >= '0' && c <= '9') {
+                value |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                value |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                value |= c - 'A' + 10;
+            } else {
+                fail("Invalid unicode escape");
+            }
+        }
+
+        return value;
+    }
+
+    static void appendCodePoint(std::string& out, std::uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            out += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            out += static_cast<char>(0xc0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3f));
+        } else if (codePoint < 0x10000) {
+            out += static_cast<char>(0xe0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (codePoint & 0x3f));
+        } else {
+            out += static_cast<char>(0xf0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (codePoint & 0x3f));
+        }
+    }
+
+    // Targets are ints in the actions, so anything that does not fit is rejected rather than silently narrowed
+    int parseInteger() {
+        skipWhitespace();
+
+        bool negative = consumeRaw('-');
+
+        std::size_t digitsStart = pos;
+        long long value = 0;
+
+        while (pos < input.size() && input[pos] >= '0' && input[pos] <= '9') {
+            value = value * 10 + (input[pos++] - '0');
+
+            if (value > static_cast<long long>(std::numeric_limits<int>::max()) + 1) {
+                pos = digitsStart;
+                fail("Integer out of range");
+            }
+        }
+
+        if (pos == digitsStart) {
+            fail("Expected integer");
+        }
+
+        // The GUI writes plain numbers, but accept integral values such as 12.0 or 1e2 like nlohmann does
+        if (pos < input.size() && (input[pos] == '.' || input[pos] == 'e' || input[pos] == 'E')) {
+            pos = digitsStart;
+            double number = parseNumberAsDouble();
+
+            if (!std::isfinite(number) || number > static_cast<double>(std::numeric_limits<int>::max()) + 1) {
+                pos = digitsStart;
+                fail("Integer out of range");
+            }
+
+            if (number != std::trunc(number)) {
+                pos = digitsStart;
+                fail("Expected integer");
+            }
+
+            value = static_cast<long long>(number);
+        }
+
+        if (negative) {
+            value = -value;
+        }
+
+        if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+            pos = digitsStart;
+            fail("Integer out of range");
+        }
+
+        return static_cast<int>(value);
+    }
+
+    double parseNumberAsDouble() {
+        std::size_t start = pos;
+        while (pos < input.size() && isNumberCharacter(input[pos])) {
+            ++pos;
+        }
+
+        std::string number(input.substr(start, pos - start));
+
+        std::size_t parsed = 0;
+        double value = 0;
+
+        try {
+            value = std::stod(number, &parsed);
+        } catch (const std::exception&) {
+            pos = start;
+            fail("Invalid number");
+        }
+
+        if (parsed != number.size()) {
+            pos = start + parsed;
+            fail("Invalid number");
+        }
+
+        return value;
+    }
+
+    static bool isNumberCharacter(char c) {
+        return (c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    void skipValue() {
+        skipWhitespace();
+        if (pos >= input.size()) {
+            fail("Expected value");
+        }
+
+        char c = input[pos];
+
+        if (c == '"') {
+            parseString();
+        } else if (c == '{') {
+            ++pos;
+            if (!consume('}')) {
+                do {
+                    parseString();
+                    expect(':');
+                    skipValue();
+                } while (consume(','));
+
+                expect('}');
+            }
+        } else if (c == '[') {
+            ++pos;
+            if (!consume(']')) {
+                do {
+                    skipValue();
+                } while (consume(','));
+
+                expect(']');
+            }
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            consumeRaw('-');
+            parseNumberAsDouble();
+        } else if (!consumeLiteral("true") && !consumeLiteral("false") && !consumeLiteral("null")) {
+            fail("Expected value");
+        }
+    }
+
+    void skipWhitespace() {
+        while (pos < input.size()) {
+            char c = input[pos];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                break;
+            }
+
+            ++pos;
+        }
+    }
+
+    bool consumeRaw(char c) {
+        if (pos < input.size() && input[pos] == c) {
+            ++pos;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool consume(char c) {
+        skipWhitespace();
+        return consumeRaw(c);
+    }
+
+    bool consumeLiteral(std::string_view literal) {
+        if (input.substr(pos, literal.size()) == literal) {
+            pos += literal.size();
+            return true;
+        }
+
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) {
+            fail(fmt::format("Expected '{}'", c));
+        }
+    }
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error(fmt::format("Cannot parse solution at offset {}: {}", pos, message));
+    }
+};
+
+inline std::vector<std::unique_ptr<Action>> parseSolution(std::string_view json) {
+    return SolutionParser(json).parse();
+}
+
+inline std::vector<std::unique_ptr<Action>> loadSolution(const std::filesystem::path& file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error(fmt::format("Cannot open solution {}", file.string()));
+    }
+
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return parseSolution(content);
+}
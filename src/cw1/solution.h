@@ -6,8 +6,21 @@
 
 #include <nlohmann/json.hpp>
 
+#include <cw1/json-writer.h>
 #include <cw1/test.h>
 
+inline int calculateGold(long long gold, long long fatigue) {
+    return std::floor(static_cast<double>(gold) * (1000.0 / (1000.0 + static_cast<double>(fatigue))) + 1e-6);
+}
+
+inline int calculateStat(int level, int base, int coeff) {
+    double levelDouble = level;
+    double baseDouble = base;
+    double coeffDouble = coeff;
+
+    return std::floor(baseDouble * (1.0 + levelDouble * (coeffDouble / 100.0)) + 1e-6);
+}
+
 struct State {
     Test test;
 
@@ -64,6 +77,27 @@ struct Action {
 
         return obj;
     }
+
+    // Produces the same bytes as toJson().dump() without building a DOM
+    void writeJson(std::string& out) const {
+        out += '{';
+
+        if (!comment.empty()) {
+            out += "\"comment\":";
+            appendJsonString(out, comment);
+            out += ',';
+        }
+
+        writeJsonFields(out);
+
+        out += "\"type\":";
+        appendJsonString(out, type);
+        out += '}';
+    }
+
+protected:
+    // Writes the action-specific keys, each followed by a comma, they all sort between "comment" and "type"
+    virtual void writeJsonFields(std::string&) const {}
 };
 
 struct MoveAction : Action {
@@ -90,6 +124,15 @@ struct MoveAction : Action {
         json["target_y"] = y;
         return json;
     }
+
+protected:
+    void writeJsonFields(std::string& out) const override {
+        out += "\"target_x\":";
+        appendJsonNumber(out, x);
+        out += ",\"target_y\":";
+        appendJsonNumber(out, y);
+        out += ',';
+    }
 };
 
 struct AttackAction : Action {
@@ -105,8 +148,7 @@ struct AttackAction : Action {
         monster.hp -= state.power;
 
         if (monster.hp <= 0) {
-            state.gold += std::floor(
-                static_cast<double>(monster.gold) * (1000.0 / (1000.0 + static_cast<double>(state.fatigue))) + 1e-6);
+            state.gold += calculateGold(monster.gold, state.fatigue);
             state.exp += monster.exp;
 
             int oldLevel = state.level;
@@ -137,13 +179,11 @@ struct AttackAction : Action {
         return json;
     }
 
-private:
-    int calculateStat(int level, int base, int coeff) const {
-        double levelDouble = level;
-        double baseDouble = base;
-        double coeffDouble = coeff;
-
-        return std::floor(baseDouble * (1.0 + levelDouble * (coeffDouble / 100.0)) + 1e-6);
+protected:
+    void writeJsonFields(std::string& out) const override {
+        out += "\"target_id\":";
+        appendJsonNumber(out, target);
+        out += ',';
     }
 };
 
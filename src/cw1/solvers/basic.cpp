@@ -1,103 +1,167 @@
 #include <algorithm>
+#include <array>
+#include <cstddef>
 #include <memory>
 #include <vector>
 
 #include <ankerl/unordered_dense.h>
-#include <oneapi/tbb/parallel_for_each.h>
 
+#include <cw1/batch-solution.h>
 #include <cw1/grid-search.h>
+#include <cw1/job.h>
+#include <cw1/path-planner.h>
 #include <cw1/program.h>
 #include <cw1/solution.h>
 #include <cw1/test.h>
 
-void solve(Program& program, const Test& test) {
+constexpr std::size_t batchSize = 16;
+
+// Sort keys of a monster for a single lane and turn, sorting these instead of monsters keeps comparisons cheap
+struct MonsterCandidate {
+    int value;
+    int distance;
+    int id;
+    bool targetable;
+};
+
+void solve(Program& program, const Test& test, const Job& job) {
     program.logStart(test);
 
+    PathPlanner planner(test);
+
     GridSearch gridSearch;
     gridSearch.addParameter("preferExpThreshold", 0.0, 1.0, 0.05);
     gridSearch.addParameter("passMonsterThreshold", 0.0, 1.0, 0.05);
 
-    gridSearch.run(
-        [&](const ankerl::unordered_dense::map<std::string, double>& values) {
-            int preferExpThreshold = test.noTurns * values.at("preferExpThreshold");
-            double passMonsterThreshold = values.at("passMonsterThreshold");
+    // The budget is the number of parameter combinations to roll out, seeds pick different subsets of the grid
+    gridSearch.setSeed(job.seed);
+    gridSearch.setBudget(job.budget);
+
+    gridSearch.runBatched<batchSize>(
+        [&](const std::vector<ankerl::unordered_dense::map<std::string, double>>& batch) {
+            std::size_t noLanes = batch.size();
 
-            State state(test);
-            std::vector<std::unique_ptr<Action>> actions;
+            std::array<int, batchSize> preferExpThresholds;
+            std::array<double, batchSize> passMonsterThresholds;
+            for (std::size_t lane = 0; lane < noLanes; ++lane) {
+                preferExpThresholds[lane] = test.noTurns * batch[lane].at("preferExpThreshold");
+                passMonsterThresholds[lane] = batch[lane].at("passMonsterThreshold");
+            }
 
-            for (int i = 0; i < state.test.noTurns; ++i) {
-                bool preferExp = i < preferExpThreshold;
+            BatchState<batchSize> state(test);
+            std::vector<std::vector<std::unique_ptr<Action>>> actions(noLanes);
 
-                long long targetValue = 0;
-                for (const auto& monster : state.test.monsters) {
-                    if (monster.hp <= 0 || monster.hp > state.power * 100) {
-                        continue;
-                    }
+            std::array<std::vector<MonsterCandidate>, batchSize> candidates;
+            for (std::size_t lane = 0; lane < noLanes; ++lane) {
+                candidates[lane].reserve(test.monsters.size());
+            }
 
-                    targetValue = std::max(targetValue, preferExp ? monster.exp : monster.gold);
+            for (int i = 0; i < test.noTurns; ++i) {
+                BatchActions<batchSize> turnActions;
+
+                std::array<bool, batchSize> preferExp;
+                std::array<long long, batchSize> maxTargetableHp;
+                std::array<long long, batchSize> targetValues{};
+
+                for (std::size_t lane = 0; lane < noLanes; ++lane) {
+                    preferExp[lane] = i < preferExpThresholds[lane];
+                    maxTargetableHp[lane] = state.power[lane] * 100;
+                    candidates[lane].clear();
                 }
 
-                long long minValue = targetValue * passMonsterThreshold;
+                // Monster-outer so every monster and its hp row are read once per turn for the whole batch
+                for (const auto& monster : test.monsters) {
+                    const auto& hp = state.monsterHp[monster.id];
 
-                auto sortedMonsters = state.test.monsters;
-                std::ranges::sort(
-                    sortedMonsters,
-                    [&](const Monster& a, const Monster& b) {
-                        int valueA = preferExp ? a.exp : a.gold;
-                        int valueB = preferExp ? b.exp : b.gold;
+                    for (std::size_t lane = 0; lane < noLanes; ++lane) {
+                        bool targetable = hp[lane] > 0 && hp[lane] <= maxTargetableHp[lane];
 
-                        if (valueA >= minValue && valueB >= minValue) {
-                            return state.position.distanceTo(a.position) < state.position.distanceTo(b.position);
+                        long long value = preferExp[lane] ? monster.exp : monster.gold;
+                        if (targetable) {
+                            targetValues[lane] = std::max(targetValues[lane], value);
                         }
 
-                        return valueA > valueB;
-                    });
+                        candidates[lane].push_back(
+                            {static_cast<int>(value),
+                             monster.position.distanceTo(state.x[lane], state.y[lane]),
+                             monster.id,
+                             targetable});
+                    }
+                }
 
-                bool attacked = false;
+                for (std::size_t lane = 0; lane < noLanes; ++lane) {
+                    Position position = state.position(lane);
+                    long long rangeSquared = static_cast<long long>(state.range[lane]) * state.range[lane];
+                    long long minValue = targetValues[lane] * passMonsterThresholds[lane];
 
-                for (const auto& monster : sortedMonsters) {
-                    if (monster.hp <= 0 || monster.hp > state.power * 100) {
-                        continue;
+                    auto& laneCandidates = candidates[lane];
+
+                    std::ranges::sort(
+                        laneCandidates,
+                        [&](const MonsterCandidate& a, const MonsterCandidate& b) {
+                            if (a.value >= minValue && b.value >= minValue) {
+                                return a.distance < b.distance;
+                            }
+
+                            return a.value > b.value;
+                        });
+
+                    bool attacked = false;
+
+                    for (const auto& candidate : laneCandidates) {
+                        if (!candidate.targetable || candidate.value < minValue) {
+                            continue;
+                        }
+
+                        if (candidate.distance <= rangeSquared) {
+                            turnActions.attack(lane, candidate.id);
+                            actions[lane].emplace_back(attack(candidate.id));
+                            attacked = true;
+                            break;
+                        }
                     }
 
-                    int currentValue = preferExp ? monster.exp : monster.gold;;
-                    if (currentValue < minValue) {
+                    if (attacked) {
                         continue;
                     }
 
-                    if (monster.position.isInRange(state.position, state.range)) {
-                        actions.emplace_back(attack(state, monster.id));
-                        attacked = true;
+                    for (const auto& candidate : laneCandidates) {
+                        if (!candidate.targetable) {
+                            continue;
+                        }
+
+                        auto target = planner.nextPosition(
+                            position,
+                            state.speed[lane],
+                            test.monsters[candidate.id].position,
+                            state.range[lane],
+                            [&](int monsterId) {
+                                return state.isAlive(lane, monsterId);
+                            });
+
+                        turnActions.move(lane, target);
+                        actions[lane].emplace_back(move(target));
                         break;
                     }
                 }
 
-                if (attacked) {
-                    continue;
-                }
-
-                for (const auto& monster : sortedMonsters) {
-                    if (monster.hp <= 0 || monster.hp > state.power * 100) {
-                        continue;
-                    }
-
-                    actions.emplace_back(move(state, state.position.positionTowards(monster.position, state.speed)));
-                    break;
-                }
+                state.apply(turnActions);
             }
 
-            program.submit(test, actions);
+            for (const auto& laneActions : actions) {
+                program.submit(test, laneActions);
+            }
         });
 }
 
 int main(int argc, char* argv[]) {
     Program program;
-    auto tests = program.parseArgs(argc, argv);
 
-    tbb::parallel_for_each(
-        tests,
-        [&](const Test& test) {
-            solve(program, test);
+    program.run(
+        argc,
+        argv,
+        [&](const Test& test, const Job& job) {
+            solve(program, test, job);
         });
 
     return 0;
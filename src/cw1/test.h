@@ -2,12 +2,16 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <string>
 #include <vector>
 
+#include <ankerl/unordered_dense.h>
 #include <fmt/format.h>
 #include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
 
 #include <cw1/config.h>
 
@@ -191,3 +195,66 @@ inline std::vector<Test> getAllTests() {
 
     return tests;
 }
+
+// Selects tests from arguments like "1 5 26-50", all tests when there are none, argv[0] is skipped
+inline std::vector<Test> parseTestArgs(int argc, char* argv[]) {
+    std::vector<int> orderedIds;
+    ankerl::unordered_dense::set<int> seenIds;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+
+        auto rangeSeparator = arg.find('-');
+        if (rangeSeparator != std::string::npos) {
+            int lhs = std::stoi(arg.substr(0, rangeSeparator));
+            int rhs = std::stoi(arg.substr(rangeSeparator + 1));
+
+            for (int j = lhs; j <= rhs; ++j) {
+                if (!seenIds.contains(j)) {
+                    orderedIds.emplace_back(j);
+                    seenIds.emplace(j);
+                }
+            }
+        } else {
+            int id = std::stoi(arg);
+            if (!seenIds.contains(id)) {
+                orderedIds.emplace_back(id);
+                seenIds.emplace(id);
+            }
+        }
+    }
+
+    auto allTests = getAllTests();
+    spdlog::info("Test count: {}", allTests.size());
+
+    if (orderedIds.empty()) {
+        orderedIds.reserve(allTests.size());
+        for (const auto& test : allTests) {
+            orderedIds.emplace_back(test.id);
+        }
+    }
+
+    std::vector<Test> selectedTests;
+    selectedTests.reserve(orderedIds.size());
+
+    std::vector<int> selectedTestIds;
+    selectedTestIds.reserve(orderedIds.size());
+
+    for (int id : orderedIds) {
+        if (id < 1 || id > static_cast<int>(allTests.size())) {
+            spdlog::warn("{} is not a valid test id", id);
+            continue;
+        }
+
+        selectedTests.emplace_back(allTests[id - 1]);
+        selectedTestIds.emplace_back(id);
+    }
+
+    if (selectedTests.empty()) {
+        spdlog::error("No tests to solve");
+        std::exit(1);
+    }
+
+    spdlog::info("Solving ({}): {}", selectedTests.size(), spdlog::fmt_lib::join(selectedTestIds, " "));
+    return selectedTests;
+}
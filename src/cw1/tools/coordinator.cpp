@@ -0,0 +1,86 @@
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include <cw1/coordinator.h>
+#include <cw1/program.h>
+
+// Serves (test, solver, seed) jobs to workers and submits the best solutions they push back
+//
+// coordinator [--host <host>] [--port <port>] [--solver <name>]... [--seeds <count>] [--budget <budget>]
+//             [--lease <seconds>] [tests...]
+//
+// Workers are regular solver executables started with COORDINATOR_URL pointing at this process
+// A job that is not finished within the lease (default one hour) is handed out again
+// Solvers shuffle their search by the job's seed and cap it by the budget, without a budget every seed covers the
+// same full search and only repeats the work of the first
+
+int main(int argc, char* argv[]) {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    std::vector<std::string> solvers;
+    int noSeeds = 1;
+    int budget = 0;
+    int leaseSeconds = 3600;
+
+    std::vector<std::string> testArgs{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--host" && hasValue) {
+            host = argv[++i];
+        } else if (arg == "--port" && hasValue) {
+            port = std::stoi(argv[++i]);
+        } else if (arg == "--solver" && hasValue) {
+            solvers.emplace_back(argv[++i]);
+        } else if (arg == "--seeds" && hasValue) {
+            noSeeds = std::stoi(argv[++i]);
+        } else if (arg == "--budget" && hasValue) {
+            budget = std::stoi(argv[++i]);
+        } else if (arg == "--lease" && hasValue) {
+            leaseSeconds = std::stoi(argv[++i]);
+        } else {
+            testArgs.emplace_back(arg);
+        }
+    }
+
+    if (noSeeds > 1 && budget == 0) {
+        spdlog::warn("--seeds {} without --budget repeats the same full search for every seed", noSeeds);
+    }
+
+    if (solvers.empty()) {
+        solvers.emplace_back("basic");
+    }
+
+    Program program;
+    if (program.isWorker()) {
+        spdlog::error("COORDINATOR_URL must not be set for the coordinator itself");
+        return 1;
+    }
+
+    std::vector<char*> testArgv;
+    for (auto& arg : testArgs) {
+        testArgv.emplace_back(arg.data());
+    }
+
+    auto tests = Program::parseArgs(testArgv.size(), testArgv.data());
+
+    Coordinator coordinator(program, tests, std::chrono::seconds(leaseSeconds));
+    for (int seed = 0; seed < noSeeds; ++seed) {
+        for (const auto& solver : solvers) {
+            for (const auto& test : tests) {
+                coordinator.addJob(test.id, solver, seed, budget);
+            }
+        }
+    }
+
+    if (!coordinator.listen(host, port)) {
+        spdlog::error("Cannot listen on {}:{}", host, port);
+        return 1;
+    }
+
+    return 0;
+}
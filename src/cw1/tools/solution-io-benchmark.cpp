@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <cw1/solution.h>
+#include <cw1/solution-io.h>
+#include <cw1/test.h>
+
+// Checks that the streaming solution writer and parser round-trip against the nlohmann::json path,
+// then compares their throughput on solutions as long as the largest tests allow
+
+std::vector<std::unique_ptr<Action>> generateActions(const Test& test, std::mt19937& rng) {
+    static const std::vector<std::string> comments{
+        "",
+        "farm exp",
+        "quote \" and backslash \\",
+        "tab\tnewline\ncontrol \x01\x1f",
+        "unicode caf\xc3\xa9 \xe2\x86\x92 \xf0\x9f\x90\xab",
+    };
+
+    std::uniform_int_distribution<int> xDistribution(0, test.width);
+    std::uniform_int_distribution<int> yDistribution(0, test.height);
+    std::uniform_int_distribution<int> monsterDistribution(0, static_cast<int>(test.monsters.size()) - 1);
+    std::uniform_int_distribution<int> commentDistribution(0, 7 * static_cast<int>(comments.size()));
+
+    std::vector<std::unique_ptr<Action>> actions;
+    actions.reserve(test.noTurns);
+
+    for (int i = 0; i < test.noTurns; ++i) {
+        int commentIndex = commentDistribution(rng);
+        auto comment = commentIndex < static_cast<int>(comments.size()) ? comments[commentIndex] : "";
+
+        if (rng() % 2 == 0) {
+            actions.emplace_back(move(xDistribution(rng), yDistribution(rng), comment));
+        } else {
+            actions.emplace_back(attack(monsterDistribution(rng), comment));
+        }
+    }
+
+    return actions;
+}
+
+nlohmann::json toJsonSolution(const std::vector<std::unique_ptr<Action>>& actions) {
+    std::vector<nlohmann::json> moves;
+    moves.reserve(actions.size());
+    for (const auto& action : actions) {
+        moves.emplace_back(action->toJson());
+    }
+
+    return nlohmann::json{{"moves", moves}};
+}
+
+// Mirrors JSON.stringify() in the GUI, which keeps keys in insertion order
+std::string toGuiSolution(const std::vector<std::unique_ptr<Action>>& actions) {
+    nlohmann::ordered_json moves = nlohmann::ordered_json::array();
+
+    for (const auto& action : actions) {
+        nlohmann::ordered_json move{{"type", action->type}};
+        if (!action->comment.empty()) {
+            move["comment"] = action->comment;
+        }
+
+        if (auto moveAction = dynamic_cast<const MoveAction*>(action.get())) {
+            move["target_x"] = moveAction->x;
+            move["target_y"] = moveAction->y;
+        } else if (auto attackAction = dynamic_cast<const AttackAction*>(action.get())) {
+            move["target_id"] = attackAction->target;
+        }
+
+        moves.emplace_back(move);
+    }
+
+    return nlohmann::ordered_json{{"moves", moves}}.dump(2);
+}
+
+// Goes through a temporary file, a pipe would block once the solution outgrows the pipe buffer
+std::string writeThroughFile(const std::vector<std::unique_ptr<Action>>& actions, std::size_t bufferSize) {
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::tmpfile(), &std::fclose);
+    if (!file) {
+        throw std::runtime_error("Cannot create temporary file");
+    }
+
+    writeSolution(fileno(file.get()), actions, bufferSize);
+
+    std::string content;
+    ::lseek(fileno(file.get()), 0, SEEK_SET);
+
+    char chunk[4096];
+    ssize_t n;
+    while ((n = ::read(fileno(file.get()), chunk, sizeof(chunk))) > 0) {
+        content.append(chunk, n);
+    }
+
+    return content;
+}
+
+bool checkRoundTrip(const Test& test, const std::vector<std::unique_ptr<Action>>& actions) {
+    auto expected = toJsonSolution(actions).dump();
+
+    auto streamed = serializeSolution(actions);
+    if (streamed != expected) {
+        spdlog::error("[Test {}] Streamed output differs from nlohmann::json output", test.id);
+        return false;
+    }
+
+    // A small buffer forces a flush every few actions, the default one flushes mid-solution on the largest tests
+    for (std::size_t bufferSize : {std::size_t(64), std::size_t(64 * 1024)}) {
+        if (writeThroughFile(actions, bufferSize) != expected) {
+            spdlog::error("[Test {}] Output written to a file with a {} byte buffer differs", test.id, bufferSize);
+            return false;
+        }
+    }
+
+    if (serializeSolution(parseSolution(streamed)) != expected) {
+        spdlog::error("[Test {}] Parsing streamed output does not round-trip", test.id);
+        return false;
+    }
+
+    if (serializeSolution(parseSolution(toJsonSolution(actions).dump(4))) != expected) {
+        spdlog::error("[Test {}] Parsing indented nlohmann::json output does not round-trip", test.id);
+        return false;
+    }
+
+    if (serializeSolution(parseSolution(toGuiSolution(actions))) != expected) {
+        spdlog::error("[Test {}] Parsing GUI-style output does not round-trip", test.id);
+        return false;
+    }
+
+    return true;
+}
+
+template<typename F>
+double measureSeconds(int iterations, F&& func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void benchmark(const Test& test, const std::vector<std::unique_ptr<Action>>& actions, int iterations) {
+    auto serialized = serializeSolution(actions);
+    double megabytes = static_cast<double>(serialized.size()) * iterations / 1e6;
+
+    std::size_t sink = 0;
+
+    double domWrite = measureSeconds(iterations, [&] { sink += toJsonSolution(actions).dump().size(); });
+    double streamWrite = measureSeconds(iterations, [&] { sink += serializeSolution(actions).size(); });
+
+    int devNull = ::open("/dev/null", O_WRONLY);
+    double fdWrite = measureSeconds(iterations, [&] { writeSolution(devNull, actions); });
+    ::close(devNull);
+
+    double domRead = measureSeconds(
+        iterations,
+        [&] {
+            auto json = nlohmann::json::parse(serialized);
+            for (const auto& move : json["moves"]) {
+                if (move["type"] == "move") {
+                    sink += MoveAction(move["target_x"].get<int>(), move["target_y"].get<int>()).x;
+                } else {
+                    sink += AttackAction(move["target_id"].get<int>()).target;
+                }
+            }
+        });
+
+    double streamRead = measureSeconds(iterations, [&] { sink += parseSolution(serialized).size(); });
+
+    spdlog::info(
+        "[Test {}] {} actions, {} bytes | write: nlohmann {:.1f} MB/s, streaming {:.1f} MB/s ({:.1f}x), fd {:.1f} MB/s | read: nlohmann {:.1f} MB/s, streaming {:.1f} MB/s ({:.1f}x)",
+        test.id,
+        actions.size(),
+        serialized.size(),
+        megabytes / domWrite,
+        megabytes / streamWrite,
+        domWrite / streamWrite,
+        megabytes / fdWrite,
+        megabytes / domRead,
+        megabytes / streamRead,
+        domRead / streamRead);
+
+    // Keeps the measured work observable so it is not optimized away
+    spdlog::debug("[Test {}] Checksum: {}", test.id, sink);
+}
+
+int main(int argc, char* argv[]) {
+    int noTests = argc > 1 ? std::stoi(argv[1]) : 5;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 200;
+
+    auto tests = getAllTests();
+    std::ranges::sort(tests, [](const Test& a, const Test& b) { return a.noTurns > b.noTurns; });
+    tests.erase(tests.begin() + std::min<std::size_t>(tests.size(), noTests), tests.end());
+
+    std::mt19937 rng(42);
+    bool ok = true;
+
+    for (const auto& test : tests) {
+        auto actions = generateActions(test, rng);
+
+        if (!checkRoundTrip(test, actions)) {
+            ok = false;
+            continue;
+        }
+
+        benchmark(test, actions, iterations);
+    }
+
+    if (!ok) {
+        return 1;
+    }
+
+    spdlog::info("All solutions round-trip");
+    return 0;
+}
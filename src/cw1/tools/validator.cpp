@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <locale>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <oneapi/tbb/parallel_for.h>
+#include <spdlog/spdlog.h>
+
+#include <cw1/reference-solution.h>
+#include <cw1/solution.h>
+#include <cw1/solution-io.h>
+#include <cw1/test.h>
+#include <cw1/trace.h>
+
+// Replays solutions through both the optimized simulators and a port of the GUI engine and reports where they diverge
+//
+// validator replay [--traces <directory>] <test>:<solution> [<test>:<solution> ...]
+// validator diff <trace> <trace>
+// validator fuzz [--iterations <count>] [--seed <seed>] [tests...]
+
+constexpr std::size_t fuzzBatchSize = 8;
+
+struct ReplayJob {
+    int testId;
+    std::filesystem::path solution;
+};
+
+std::optional<ReplayJob> parseReplayJob(const std::string& arg) {
+    auto separator = arg.find(':');
+    if (separator == std::string::npos) {
+        return std::nullopt;
+    }
+
+    return ReplayJob{std::stoi(arg.substr(0, separator)), arg.substr(separator + 1)};
+}
+
+bool replay(
+    const Test& test,
+    const std::filesystem::path& file,
+    const std::optional<std::filesystem::path>& tracesDirectory,
+    std::size_t jobIndex) {
+    auto actions = loadSolution(file);
+
+    bool ok = true;
+
+    if (actions.size() > static_cast<std::size_t>(test.noTurns)) {
+        spdlog::warn("[{}] {} actions exceed the {} turns of test {}", file.string(), actions.size(), test.noTurns, test.id);
+        actions.erase(actions.begin() + test.noTurns, actions.end());
+        ok = false;
+    }
+
+    // Only the legal prefix is replayed, the scalar simulator does not guard against invalid monster ids
+    ReferenceState validator(test);
+    for (std::size_t i = 0; i < actions.size(); ++i) {
+        auto violation = validator.findViolation(*actions[i]);
+        if (violation) {
+            spdlog::warn("[{}] Turn {}: {}", file.string(), i, *violation);
+            actions.erase(actions.begin() + i, actions.end());
+            ok = false;
+            break;
+        }
+
+        validator.apply(*actions[i]);
+    }
+
+    auto trace = traceSolution(test, actions);
+    auto referenceTrace = traceReferenceSolution(test, actions);
+
+    // Replays run in parallel and solutions for one test often share a file name, so the job index keeps names unique
+    if (tracesDirectory) {
+        auto name = fmt::format("{}-{:03d}-{}", jobIndex, test.id, file.stem().string());
+        trace.write(*tracesDirectory / fmt::format("{}.cpp.trace", name));
+        referenceTrace.write(*tracesDirectory / fmt::format("{}.reference.trace", name));
+
+        spdlog::info("[{}] Wrote traces to {}/{}.*.trace", file.string(), tracesDirectory->string(), name);
+    }
+
+    auto divergence = trace.findDivergence(referenceTrace);
+    if (divergence) {
+        spdlog::error(
+            "[{}] C++ simulator diverges from the reference at {}",
+            file.string(),
+            trace.describeDivergence(referenceTrace, *divergence));
+        return false;
+    }
+
+    int gold = trace.records.empty() ? 0 : trace.records.back().gold;
+    spdlog::info("[{}] Test {}: {} actions, gold {:L}", file.string(), test.id, actions.size(), gold);
+
+    return ok;
+}
+
+int runReplay(const std::vector<std::string>& args) {
+    std::optional<std::filesystem::path> tracesDirectory;
+    std::vector<ReplayJob> jobs;
+
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--traces" && i + 1 < args.size()) {
+            tracesDirectory = args[++i];
+            std::filesystem::create_directories(*tracesDirectory);
+            continue;
+        }
+
+        auto job = parseReplayJob(args[i]);
+        if (!job) {
+            spdlog::error("Expected <test>:<solution>, got {}", args[i]);
+            return 1;
+        }
+
+        jobs.emplace_back(*job);
+    }
+
+    auto tests = getAllTests();
+    std::atomic<bool> ok = true;
+
+    tbb::parallel_for(
+        std::size_t(0),
+        jobs.size(),
+        [&](std::size_t jobIndex) {
+            const auto& job = jobs[jobIndex];
+
+            if (job.testId < 1 || job.testId > static_cast<int>(tests.size())) {
+                spdlog::error("[{}] {} is not a valid test id", job.solution.string(), job.testId);
+                ok = false;
+                return;
+            }
+
+            try {
+                if (!replay(tests[job.testId - 1], job.solution, tracesDirectory, jobIndex)) {
+                    ok = false;
+                }
+            } catch (const std::exception& e) {
+                spdlog::error("[{}] {}", job.solution.string(), e.what());
+                ok = false;
+            }
+        });
+
+    return ok ? 0 : 1;
+}
+
+int runDiff(const std::vector<std::string>& args) {
+    if (args.size() != 2) {
+        spdlog::error("Expected two trace files");
+        return 1;
+    }
+
+    auto lhs = Trace::read(args[0]);
+    auto rhs = Trace::read(args[1]);
+
+    if (lhs.testId != rhs.testId) {
+        spdlog::warn("Traces belong to different tests ({} and {})", lhs.testId, rhs.testId);
+    }
+
+    auto divergence = lhs.findDivergence(rhs);
+    if (!divergence) {
+        spdlog::info("Traces are identical ({} records)", lhs.records.size());
+        return 0;
+    }
+
+    spdlog::info("Traces diverge at {}", lhs.describeDivergence(rhs, *divergence));
+    return 1;
+}
+
+// Picks uniformly among a few legal action kinds so both kills and long detours show up in every rollout
+std::vector<std::unique_ptr<Action>> generateLegalActions(const Test& test, std::mt19937& rng) {
+    std::vector<std::unique_ptr<Action>> actions;
+    actions.reserve(test.noTurns);
+
+    ReferenceState state(test);
+    std::vector<int> inRange;
+    std::vector<int> alive;
+
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    for (int i = 0; i < test.noTurns; ++i) {
+        Position position(state.x, state.y);
+
+        inRange.clear();
+        alive.clear();
+
+        for (const auto& monster : test.monsters) {
+            if (state.monsterHp[monster.id] <= 0) {
+                continue;
+            }
+
+            alive.emplace_back(monster.id);
+            if (monster.position.isInRange(position, state.range)) {
+                inRange.emplace_back(monster.id);
+            }
+        }
+
+        std::unique_ptr<Action> action;
+
+        if (!inRange.empty() && chance(rng) < 0.6) {
+            action = attack(inRange[rng() % inRange.size()]);
+        } else if (!alive.empty() && chance(rng) < 0.5) {
+            const auto& monster = test.monsters[alive[rng() % alive.size()]];
+            action = move(position.positionTowards(monster.position, state.speed));
+        } else {
+            int speed = state.speed;
+            std::uniform_int_distribution<int> offset(-speed, speed);
+
+            while (true) {
+                int x = position.x + offset(rng);
+                int y = position.y + offset(rng);
+
+                if (x >= 0 && x <= test.width && y >= 0 && y <= test.height && position.isInRange(x, y, speed)) {
+                    action = move(x, y);
+                    break;
+                }
+            }
+        }
+
+        state.apply(*action);
+        actions.emplace_back(std::move(action));
+    }
+
+    return actions;
+}
+
+bool fuzz(const Test& test, unsigned int seed) {
+    std::vector<std::vector<std::unique_ptr<Action>>> solutions;
+    std::vector<const std::vector<std::unique_ptr<Action>>*> solutionPointers;
+
+    for (std::size_t lane = 0; lane < fuzzBatchSize; ++lane) {
+        std::mt19937 rng(seed + lane);
+        solutions.emplace_back(generateLegalActions(test, rng));
+    }
+
+    for (const auto& solution : solutions) {
+        solutionPointers.emplace_back(&solution);
+    }
+
+    auto batchTraces = traceBatchSolutions<fuzzBatchSize>(test, solutionPointers);
+
+    bool ok = true;
+
+    for (std::size_t lane = 0; lane < fuzzBatchSize; ++lane) {
+        auto referenceTrace = traceReferenceSolution(test, solutions[lane]);
+        auto trace = traceSolution(test, solutions[lane]);
+
+        auto report = [&](const std::string& engine, const Trace& other) {
+            auto divergence = referenceTrace.findDivergence(other);
+            if (!divergence) {
+                return;
+            }
+
+            auto file = std::filesystem::current_path() / fmt::format("fuzz-{:03d}-{}.json", test.id, seed + lane);
+            std::ofstream(file) << serializeSolution(solutions[lane]);
+
+            spdlog::error(
+                "[Test {}] {} simulator diverges from the reference for seed {} (saved to {}) at {}",
+                test.id,
+                engine,
+                seed + lane,
+                file.string(),
+                referenceTrace.describeDivergence(other, *divergence));
+
+            ok = false;
+        };
+
+        report("Scalar", trace);
+        report("Batch", batchTraces[lane]);
+    }
+
+    return ok;
+}
+
+int runFuzz(const std::vector<std::string>& args, const char* program) {
+    int iterations = 10;
+    unsigned int seed = std::random_device()();
+
+    std::vector<std::string> testArgs{program};
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--iterations" && i + 1 < args.size()) {
+            iterations = std::stoi(args[++i]);
+        } else if (args[i] == "--seed" && i + 1 < args.size()) {
+            seed = std::stoul(args[++i]);
+        } else {
+            testArgs.emplace_back(args[i]);
+        }
+    }
+
+    std::vector<char*> testArgv;
+    for (auto& arg : testArgs) {
+        testArgv.emplace_back(arg.data());
+    }
+
+    auto tests = parseTestArgs(testArgv.size(), testArgv.data());
+    spdlog::info("Fuzzing {} iterations of {} rollouts per test, seed {}", iterations, fuzzBatchSize, seed);
+
+    std::atomic<bool> ok = true;
+    std::size_t noJobs = tests.size() * iterations;
+
+    tbb::parallel_for(
+        std::size_t(0),
+        noJobs,
+        [&](std::size_t job) {
+            const auto& test = tests[job % tests.size()];
+            unsigned int jobSeed = seed + (job / tests.size()) * fuzzBatchSize;
+
+            if (!fuzz(test, jobSeed)) {
+                ok = false;
+            }
+        });
+
+    if (!ok) {
+        return 1;
+    }
+
+    spdlog::info("No divergences in {:L} rollouts", noJobs * fuzzBatchSize);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::locale::global(std::locale("en_US.UTF-8"));
+
+    if (argc < 2) {
+        spdlog::error("Usage: {} <replay|diff|fuzz> [args...]", argv[0]);
+        return 1;
+    }
+
+    std::string command(argv[1]);
+    std::vector<std::string> args(argv + 2, argv + argc);
+
+    try {
+        if (command == "replay") {
+            return runReplay(args);
+        }
+
+        if (command == "diff") {
+            return runDiff(args);
+        }
+
+        if (command == "fuzz") {
+            return runFuzz(args, argv[0]);
+        }
+    } catch (const std::exception& e) {
+        spdlog::error("{}", e.what());
+        return 1;
+    }
+
+    spdlog::error("Unknown command: {}", command);
+    return 1;
+}
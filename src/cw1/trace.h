@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <cw1/batch-solution.h>
+#include <cw1/reference-solution.h>
+#include <cw1/solution.h>
+#include <cw1/test.h>
+
+// Hero state after a single turn, fixed-size so traces can be written and compared as raw memory
+struct TraceRecord {
+    std::int64_t fatigue;
+    std::int64_t targetHp;
+
+    std::int32_t turn;
+    std::int32_t x;
+    std::int32_t y;
+    std::int32_t speed;
+    std::int32_t power;
+    std::int32_t range;
+    std::int32_t level;
+    std::int32_t gold;
+    std::int32_t exp;
+
+    // Attacked monster id, -1 for moves
+    std::int32_t target;
+
+    bool operator==(const TraceRecord& other) const = default;
+
+    std::string toString() const {
+        return fmt::format(
+            "turn {}: target {} (hp {}), position ({}, {}), speed {}, power {}, range {}, level {}, gold {}, exp {}, fatigue {}",
+            turn,
+            target,
+            targetHp,
+            x,
+            y,
+            speed,
+            power,
+            range,
+            level,
+            gold,
+            exp,
+            fatigue);
+    }
+};
+
+static_assert(sizeof(TraceRecord) == 56);
+
+// Binary layout: "CW1T", uint32 version, int32 test id, uint64 record count, then the records in native byte order
+struct Trace {
+    static constexpr char magic[4] = {'C', 'W', '1', 'T'};
+    static constexpr std::uint32_t version = 1;
+
+    std::int32_t testId;
+    std::vector<TraceRecord> records;
+
+    explicit Trace(int testId)
+        : testId(testId) {}
+
+    void write(const std::filesystem::path& file) const {
+        std::ofstream out(file, std::ios::binary);
+        if (!out) {
+            throw std::runtime_error(fmt::format("Cannot open {} for writing", file.string()));
+        }
+
+        std::uint64_t noRecords = records.size();
+
+        out.write(magic, sizeof(magic));
+        out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char*>(&testId), sizeof(testId));
+        out.write(reinterpret_cast<const char*>(&noRecords), sizeof(noRecords));
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(TraceRecord));
+
+        if (!out) {
+            throw std::runtime_error(fmt::format("Cannot write trace to {}", file.string()));
+        }
+    }
+
+    static Trace read(const std::filesystem::path& file) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error(fmt::format("Cannot open {}", file.string()));
+        }
+
+        char fileMagic[4];
+        std::uint32_t fileVersion;
+        std::int32_t fileTestId;
+        std::uint64_t noRecords;
+
+        in.read(fileMagic, sizeof(fileMagic));
+        in.read(reinterpret_cast<char*>(&fileVersion), sizeof(fileVersion));
+        in.read(reinterpret_cast<char*>(&fileTestId), sizeof(fileTestId));
+        in.read(reinterpret_cast<char*>(&noRecords), sizeof(noRecords));
+
+        if (!in || !std::equal(fileMagic, fileMagic + sizeof(fileMagic), magic) || fileVersion != version) {
+            throw std::runtime_error(fmt::format("{} is not a version {} trace", file.string(), version));
+        }
+
+        // A corrupt count would otherwise turn into a huge allocation instead of a truncation error
+        auto remaining = std::filesystem::file_size(file) - static_cast<std::uintmax_t>(in.tellg());
+        if (noRecords > remaining / sizeof(TraceRecord)) {
+            throw std::runtime_error(fmt::format(
+                "{} is truncated: {} records declared, room for {}",
+                file.string(),
+                noRecords,
+                remaining / sizeof(TraceRecord)));
+        }
+
+        Trace trace(fileTestId);
+        trace.records.resize(noRecords);
+        in.read(reinterpret_cast<char*>(trace.records.data()), noRecords * sizeof(TraceRecord));
+
+        if (!in) {
+            throw std::runtime_error(fmt::format("{} is truncated", file.string()));
+        }
+
+        return trace;
+    }
+
+    // Index of the first record that differs, a length mismatch diverges at the end of the shorter trace
+    std::optional<std::size_t> findDivergence(const Trace& other) const {
+        auto [lhs, rhs] = std::mismatch(records.begin(), records.end(), other.records.begin(), other.records.end());
+        if (lhs == records.end() && rhs == other.records.end()) {
+            return std::nullopt;
+        }
+
+        return lhs - records.begin();
+    }
+
+    std::string describeDivergence(const Trace& other, std::size_t index) const {
+        auto describe = [&](const Trace& trace) {
+            return index < trace.records.size() ? trace.records[index].toString() : "<end of trace>";
+        };
+
+        return fmt::format("record {}\n  < {}\n  > {}", index, describe(*this), describe(other));
+    }
+};
+
+inline TraceRecord makeTraceRecord(int turn, const State& state, const Action& action) {
+    auto attackAction = dynamic_cast<const AttackAction*>(&action);
+
+    return {
+        state.fatigue,
+        attackAction != nullptr ? state.test.monsters[attackAction->target].hp : 0,
+        turn,
+        state.position.x,
+        state.position.y,
+        state.speed,
+        state.power,
+        state.range,
+        state.level,
+        state.gold,
+        state.exp,
+        attackAction != nullptr ? attackAction->target : -1,
+    };
+}
+
+inline TraceRecord makeTraceRecord(int turn, const ReferenceState& state, const Action& action) {
+    auto attackAction = dynamic_cast<const AttackAction*>(&action);
+
+    return {
+        static_cast<std::int64_t>(state.fatigue),
+        attackAction != nullptr ? static_cast<std::int64_t>(state.monsterHp[attackAction->target]) : 0,
+        turn,
+        static_cast<std::int32_t>(state.x),
+        static_cast<std::int32_t>(state.y),
+        static_cast<std::int32_t>(state.speed),
+        static_cast<std::int32_t>(state.power),
+        static_cast<std::int32_t>(state.range),
+        static_cast<std::int32_t>(state.level),
+        static_cast<std::int32_t>(state.gold),
+        static_cast<std::int32_t>(state.exp),
+        attackAction != nullptr ? attackAction->target : -1,
+    };
+}
+
+template<std::size_t N>
+TraceRecord makeTraceRecord(int turn, const BatchState<N>& state, std::size_t lane, const BatchActions<N>& actions) {
+    bool isAttack = actions.type[lane] == BatchActionType::Attack;
+    int target = actions.target[lane];
+
+    return {
+        state.fatigue[lane],
+        isAttack ? state.monsterHp[target][lane] : 0,
+        turn,
+        state.x[lane],
+        state.y[lane],
+        state.speed[lane],
+        state.power[lane],
+        state.range[lane],
+        state.level[lane],
+        state.gold[lane],
+        state.exp[lane],
+        isAttack ? target : -1,
+    };
+}
+
+inline Trace traceSolution(const Test& test, const std::vector<std::unique_ptr<Action>>& actions) {
+    Trace trace(test.id);
+    trace.records.reserve(actions.size());
+
+    State state(test);
+    for (std::size_t i = 0; i < actions.size(); ++i) {
+        actions[i]->apply(state);
+        trace.records.emplace_back(makeTraceRecord(i, state, *actions[i]));
+    }
+
+    return trace;
+}
+
+inline Trace traceReferenceSolution(const Test& test, const std::vector<std::unique_ptr<Action>>& actions) {
+    Trace trace(test.id);
+    trace.records.reserve(actions.size());
+
+    ReferenceState state(test);
+    for (std::size_t i = 0; i < actions.size(); ++i) {
+        state.apply(*actions[i]);
+        trace.records.emplace_back(makeTraceRecord(i, state, *actions[i]));
+    }
+
+    return trace;
+}
+
+// Replays up to N solutions in lockstep, lanes whose solution has run out stop taking turns
+template<std::size_t N>
+std::vector<Trace> traceBatchSolutions(
+    const Test& test,
+    const std::vector<const std::vector<std::unique_ptr<Action>>*>& solutions) {
+    std::vector<Trace> traces(solutions.size(), Trace(test.id));
+
+    std::size_t noTurns = 0;
+    for (const auto* solution : solutions) {
+        noTurns = std::max(noTurns, solution->size());
+    }
+
+    BatchState<N> state(test);
+
+    for (std::size_t i = 0; i < noTurns; ++i) {
+        BatchActions<N> actions;
+
+        for (std::size_t lane = 0; lane < solutions.size(); ++lane) {
+            const auto& solution = *solutions[lane];
+            if (i >= solution.size()) {
+                continue;
+            }
+
+            if (auto moveAction = dynamic_cast<const MoveAction*>(solution[i].get())) {
+                actions.move(lane, moveAction->x, moveAction->y);
+            } else if (auto attackAction = dynamic_cast<const AttackAction*>(solution[i].get())) {
+                actions.attack(lane, attackAction->target);
+            }
+        }
+
+        state.apply(actions);
+
+        for (std::size_t lane = 0; lane < solutions.size(); ++lane) {
+            if (actions.type[lane] != BatchActionType::None) {
+                traces[lane].records.emplace_back(makeTraceRecord(i, state, lane, actions));
+            }
+        }
+    }
+
+    return traces;
+}